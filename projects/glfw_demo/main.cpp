@@ -1,6 +1,7 @@
 // vta
 #include <renderer/OverviewRenderer.h>
 #include <renderer/DetailRenderer.hpp>
+#include <util/FrameProfiler.hpp>
 
 // gl
 #include <GL/glew.h>
@@ -253,6 +254,9 @@ int main(int argc, char *argv[])
 
   overview_renderer->resize(main_window_width, main_window_height); // initial resize
 
+  // Detail view uses the filters of the overview
+  detail_renderer->set_filter(overview_renderer->get_filter());
+
   if (GLEW_OK != glewInit())
 	{
 	  std::cerr << "'glewInit()' failed." << std::endl;
@@ -277,72 +281,162 @@ int main(int argc, char *argv[])
   // Blacklist
   char* buf = new char [256];
 
+  // Node filters
+  int min_degree = 0;
+  int min_cluster_size = 1;
+  int current_min_degree = min_degree;
+  int current_min_cluster_size = min_cluster_size;
+
+  // Frame timings
+  vta::FrameProfiler& profiler = vta::FrameProfiler::get();
+  bool record_profile = false;
+
   // Set Cluster Visualization in main vis
 
   // Main loop
   while (!glfwWindowShouldClose(imgui_window))
   {
+    profiler.begin_frame();
+
     glfwPollEvents();
 
     // Main Window (Visualization)
     glfwMakeContextCurrent(main_window);
-    main_window_display(); // display function
-    glfwSwapBuffers(main_window);
+    {
+      vta::FrameProfiler::CpuScope cpu_scope("overview");
+      main_window_display(); // display function
+    }
+    {
+      vta::FrameProfiler::CpuScope cpu_scope("swap");
+      glfwSwapBuffers(main_window);
+    }
 
     // Cluster Window (/Visualization)
     glfwMakeContextCurrent(cluster_window);
-    cluster_window_display(); // display function
-    glfwSwapBuffers(cluster_window);
+    {
+      vta::FrameProfiler::CpuScope cpu_scope("detail");
+      vta::FrameProfiler::GpuScope gpu_scope("detail");
+      cluster_window_display(); // display function
+    }
+    {
+      vta::FrameProfiler::CpuScope cpu_scope("swap");
+      glfwSwapBuffers(cluster_window);
+    }
 
     // Imgui Window (Interface)
     glfwMakeContextCurrent(imgui_window);
 
-    ImGui_ImplGlfw_NewFrame();
-
     {
-      ImGui::Begin("Minimum Similarity");
-      ImGui::SliderFloat("sim", &min_similarity, 0.0f, 1.0f);
-      ImGui::End();
-    }
+      vta::FrameProfiler::CpuScope cpu_scope("imgui");
 
-    {
-      ImGui::Begin("Maximum Similarity");
-      ImGui::SliderFloat("sim", &max_similarity, 0.0f, 1.0f);
-      ImGui::End();
-    }
+      ImGui_ImplGlfw_NewFrame();
 
-    {
-      ImGui::Begin("Blacklist");
-      ImGui::InputText("string", buf, 256);
+      {
+        ImGui::Begin("Minimum Similarity");
+        ImGui::SliderFloat("sim", &min_similarity, 0.0f, 1.0f);
+        ImGui::End();
+      }
 
-      if (ImGui::Button("add"))
       {
-        overview_renderer->add_to_blacklist(std::string (buf));
+        ImGui::Begin("Maximum Similarity");
+        ImGui::SliderFloat("sim", &max_similarity, 0.0f, 1.0f);
+        ImGui::End();
       }
 
-      std::vector<std::string> current_blacklist = overview_renderer->get_blacklist();
-      for (unsigned i = 0; i != current_blacklist.size(); ++i)
       {
-        std::string title = current_blacklist[i];
-        const char *cstr = title.c_str();
+        ImGui::Begin("Blacklist");
+        ImGui::InputText("string", buf, 256);
 
-        ImGui::Text(cstr);
+        if (ImGui::Button("add"))
+        {
+          overview_renderer->add_to_blacklist(std::string (buf));
+        }
 
-//        delete [] cstr;
+        std::vector<std::string> current_blacklist = overview_renderer->get_blacklist();
+        for (unsigned i = 0; i != current_blacklist.size(); ++i)
+        {
+          std::string title = current_blacklist[i];
+          const char *cstr = title.c_str();
+
+          ImGui::Text(cstr);
+
+  //        delete [] cstr;
+        }
+
+        ImGui::End();
       }
 
-      ImGui::End();
-    }
+      {
+        ImGui::Begin("Filter");
+        ImGui::SliderInt("min degree", &min_degree, 0, 100);
+        ImGui::SliderInt("min cluster size", &min_cluster_size, 1, 1000);
+        ImGui::End();
+      }
 
-    overview_renderer->set_minimum_similarity(min_similarity);
-    overview_renderer->set_maximum_similarity(max_similarity);
+      {
+        ImGui::Begin("Profiler");
+
+        // Milliseconds over the last frames
+        std::vector<vta::FrameProfiler::Statistics> statistics = profiler.get_statistics();
+
+        ImGui::Text("%-24s %4s %8s %8s %8s %8s", "section", "type", "last", "p50", "p95", "p99");
+        ImGui::Separator();
+
+        for (unsigned i = 0; i != statistics.size(); ++i)
+        {
+          vta::FrameProfiler::Statistics const& entry = statistics[i];
+
+          ImGui::Text("%-24s %4s %8.3f %8.3f %8.3f %8.3f", entry.name.c_str(), entry.gpu ? "gpu" : "cpu",
+                      entry.last, entry.p50, entry.p95, entry.p99);
+        }
+
+        ImGui::Separator();
+        ImGui::Checkbox("record profile.csv", &record_profile);
+        ImGui::End();
+      }
+
+      if (record_profile != profiler.is_csv_open())
+      {
+        if (record_profile)
+          record_profile = profiler.open_csv("profile.csv");
+        else
+          profiler.close_csv();
+      }
+
+      // Only touch the predicates that changed
+      vta::FilterEngine* filter = overview_renderer->get_filter();
+
+      if (min_degree != current_min_degree)
+      {
+        filter->set_node_predicate("degree", vta::FilterEngine::degree_range(min_degree, ~0u));
+        current_min_degree = min_degree;
+      }
+
+      if (min_cluster_size != current_min_cluster_size)
+      {
+        filter->set_node_bitmap("cluster size", vta::FilterEngine::cluster_size_range(graph, min_cluster_size, ~0u));
+        current_min_cluster_size = min_cluster_size;
+      }
+
+      overview_renderer->set_minimum_similarity(min_similarity);
+      overview_renderer->set_maximum_similarity(max_similarity);
+
+      // Rendering
+      {
+        vta::FrameProfiler::GpuScope gpu_scope("imgui");
+
+        glViewport(0, 0, (int)ImGui::GetIO().DisplaySize.x, (int)ImGui::GetIO().DisplaySize.y);
+        glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+        ImGui::Render();
+      }
+    }
+    {
+      vta::FrameProfiler::CpuScope cpu_scope("swap");
+      glfwSwapBuffers(imgui_window);
+    }
 
-    // Rendering
-    glViewport(0, 0, (int)ImGui::GetIO().DisplaySize.x, (int)ImGui::GetIO().DisplaySize.y);
-    glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
-    glClear(GL_COLOR_BUFFER_BIT);
-    ImGui::Render();
-    glfwSwapBuffers(imgui_window);
+    profiler.end_frame();
   }
 
   // Cleanup
@@ -0,0 +1,530 @@
+// vta
+#include <cluster/Visualization.hpp>
+#include <renderer/OverviewRenderer.h>
+#include <renderer/DetailRenderer.hpp>
+#include <util/FrameProfiler.hpp>
+
+// gl
+#include <GL/glew.h>
+
+// egl
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+// cpp includes
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Offscreen context on a pbuffer
+  \remarks Prefers the surfaceless Mesa platform (no display, llvmpipe without
+           a gpu), falls back to the default display. The renderers use the
+           fixed function pipeline for text, so a compatibility profile is
+           requested.
+*/
+
+struct OffscreenContext
+{
+  EGLDisplay display;
+  EGLSurface surface;
+  EGLContext context;
+};
+
+
+bool create_offscreen_context(int width, int height, OffscreenContext& offscreen)
+{
+  offscreen.display = EGL_NO_DISPLAY;
+
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+  PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+    (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+  if (get_platform_display)
+    offscreen.display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+#endif
+
+  if (offscreen.display == EGL_NO_DISPLAY)
+    offscreen.display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+  EGLint major = 0;
+  EGLint minor = 0;
+
+  if (offscreen.display == EGL_NO_DISPLAY || !eglInitialize(offscreen.display, &major, &minor))
+  {
+    std::cerr << "'eglInitialize()' failed." << std::endl;
+    return false;
+  }
+
+  std::cout << "EGL " << major << "." << minor << " " << eglQueryString(offscreen.display, EGL_VENDOR) << std::endl;
+
+  EGLint const config_attributes[] =
+  {
+    EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_RED_SIZE,        8,
+    EGL_GREEN_SIZE,      8,
+    EGL_BLUE_SIZE,       8,
+    EGL_ALPHA_SIZE,      8,
+    EGL_DEPTH_SIZE,      24,
+    EGL_NONE
+  };
+
+  EGLConfig config;
+  EGLint config_num = 0;
+
+  if (!eglChooseConfig(offscreen.display, config_attributes, &config, 1, &config_num) || config_num == 0)
+  {
+    std::cerr << "No EGL config with pbuffer and OpenGL." << std::endl;
+    return false;
+  }
+
+  EGLint const surface_attributes[] =
+  {
+    EGL_WIDTH,  width,
+    EGL_HEIGHT, height,
+    EGL_NONE
+  };
+
+  offscreen.surface = eglCreatePbufferSurface(offscreen.display, config, surface_attributes);
+
+  if (offscreen.surface == EGL_NO_SURFACE)
+  {
+    std::cerr << "'eglCreatePbufferSurface()' failed." << std::endl;
+    return false;
+  }
+
+  eglBindAPI(EGL_OPENGL_API);
+
+  EGLint const context_attributes[] =
+  {
+    EGL_CONTEXT_MAJOR_VERSION,       3,
+    EGL_CONTEXT_MINOR_VERSION,       3,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+    EGL_NONE
+  };
+
+  offscreen.context = eglCreateContext(offscreen.display, config, EGL_NO_CONTEXT, context_attributes);
+
+  if (offscreen.context == EGL_NO_CONTEXT)
+  {
+    std::cerr << "No OpenGL 3.3 compatibility context." << std::endl;
+    return false;
+  }
+
+  eglMakeCurrent(offscreen.display, offscreen.surface, offscreen.surface, offscreen.context);
+
+  std::cout << "GL " << glGetString(GL_VERSION) << " " << glGetString(GL_RENDERER) << std::endl;
+
+  return true;
+}
+
+
+void destroy_offscreen_context(OffscreenContext& offscreen)
+{
+  eglMakeCurrent(offscreen.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  eglDestroyContext(offscreen.display, offscreen.context);
+  eglDestroySurface(offscreen.display, offscreen.surface);
+  eglTerminate(offscreen.display);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Scripted frames
+  \remarks One command per line, "<frame> <command> <arguments>", # starts a
+           comment:
+             view <scale> <x> <y>       camera key frame, interpolated in between
+             min_similarity <value>
+             max_similarity <value>
+             min_degree <value>         node filter
+             detail <cluster index>     cluster of the detail view
+             key <code>                 key press on the overview (e.g. 66 = B)
+*/
+
+struct Command
+{
+  unsigned frame;
+  std::string name;
+  std::vector<double> arguments;
+};
+
+
+struct ViewKey
+{
+  unsigned frame;
+  double scale;
+  double x;
+  double y;
+};
+
+
+bool load_script(std::string const& path, std::vector<Command>& commands)
+{
+  std::ifstream file(path.c_str());
+
+  if (!file)
+  {
+    std::cerr << "Could not open script: " << path << std::endl;
+    return false;
+  }
+
+  std::string line;
+
+  while (std::getline(file, line))
+  {
+    line = line.substr(0, line.find('#'));
+
+    std::istringstream stream(line);
+
+    Command command;
+
+    if (!(stream >> command.frame >> command.name))
+      continue;
+
+    double argument;
+
+    while (stream >> argument)
+      command.arguments.push_back(argument);
+
+    commands.push_back(command);
+  }
+
+  std::stable_sort(commands.begin(), commands.end(), [](Command const& a, Command const& b) { return a.frame < b.frame; });
+
+  return true;
+}
+
+
+// Zoom out from the default view, pan across and zoom in again
+void default_script(unsigned frame_num, int width, int height, std::vector<Command>& commands)
+{
+  double const scales[] = { 0.000005, 0.0000005, 0.0000005, 0.00005 };
+  double const pans[]   = { 0.0,      0.0,       -0.5,      -0.25 };
+
+  for (unsigned i = 0; i != 4; ++i)
+  {
+    Command command;
+    command.frame = i * (frame_num - 1) / 3;
+    command.name = "view";
+    command.arguments.push_back(scales[i]);
+    command.arguments.push_back(pans[i] * width);
+    command.arguments.push_back(pans[i] * height);
+
+    commands.push_back(command);
+  }
+}
+
+
+// View at a frame, scale is interpolated logarithmically
+void interpolate_view(std::vector<ViewKey> const& keys, unsigned frame, double& scale, double& x, double& y)
+{
+  unsigned i_key = 0;
+
+  while (i_key + 1 < keys.size() && keys[i_key + 1].frame <= frame)
+    ++i_key;
+
+  ViewKey const& key = keys[i_key];
+
+  if (i_key + 1 == keys.size() || frame <= key.frame)
+  {
+    scale = key.scale;
+    x = key.x;
+    y = key.y;
+    return;
+  }
+
+  ViewKey const& next = keys[i_key + 1];
+
+  double t = (double) (frame - key.frame) / (next.frame - key.frame);
+
+  scale = exp(log(key.scale) + t * (log(next.scale) - log(key.scale)));
+  x = key.x + t * (next.x - key.x);
+  y = key.y + t * (next.y - key.y);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Writes the color buffer as binary ppm
+  \remarks Rows are flipped, gl reads bottom up
+*/
+
+void dump_frame(std::string const& path, int width, int height)
+{
+  std::vector<unsigned char> pixels(width * height * 3);
+
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+
+  std::ofstream file(path.c_str(), std::ios::binary);
+
+  file << "P6\n" << width << " " << height << "\n255\n";
+
+  for (int row = height - 1; row >= 0; --row)
+    file.write((char const*) &pixels[row * width * 3], width * 3);
+}
+
+
+std::string frame_path(std::string const& directory, char const* view, unsigned frame)
+{
+  std::ostringstream path;
+  path << directory << "/" << view << "_" << std::setw(5) << std::setfill('0') << frame << ".ppm";
+
+  return path.str();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+void print_usage()
+{
+  std::cout << "headless_bench <sim file> <offset file> [options]" << std::endl
+            << "  --frames <n>        number of frames (default 300)" << std::endl
+            << "  --size <w> <h>      framebuffer size (default 1920 1080)" << std::endl
+            << "  --script <file>     scripted camera path and filter changes" << std::endl
+            << "  --dump <directory>  write every frame of both views as ppm" << std::endl
+            << "  --csv <file>        write the timings of every frame" << std::endl
+            << "  --no-detail         only render the overview" << std::endl;
+}
+
+
+int main(int argc, char *argv[])
+{
+  if (argc < 3)
+  {
+    print_usage();
+    return 1;
+  }
+
+  unsigned frame_num = 300;
+  int width = 1920;
+  int height = 1080;
+  std::string script_path;
+  std::string dump_directory;
+  std::string csv_path;
+  bool render_detail = true;
+
+  for (int i_arg = 3; i_arg < argc; ++i_arg)
+  {
+    std::string arg = argv[i_arg];
+
+    if (arg == "--frames" && i_arg + 1 < argc)
+      frame_num = std::max(1, atoi(argv[++i_arg]));
+    else if (arg == "--size" && i_arg + 2 < argc)
+    {
+      width = atoi(argv[++i_arg]);
+      height = atoi(argv[++i_arg]);
+    }
+    else if (arg == "--script" && i_arg + 1 < argc)
+      script_path = argv[++i_arg];
+    else if (arg == "--dump" && i_arg + 1 < argc)
+      dump_directory = argv[++i_arg];
+    else if (arg == "--csv" && i_arg + 1 < argc)
+      csv_path = argv[++i_arg];
+    else if (arg == "--no-detail")
+      render_detail = false;
+    else
+    {
+      print_usage();
+      return 1;
+    }
+  }
+
+  // Frames
+  std::vector<Command> commands;
+
+  if (script_path.empty())
+    default_script(frame_num, width, height, commands);
+  else if (!load_script(script_path, commands))
+    return 1;
+
+  std::vector<ViewKey> view_keys;
+
+  for (unsigned i = 0; i != commands.size(); ++i)
+  {
+    if (commands[i].name == "view" && commands[i].arguments.size() == 3)
+    {
+      ViewKey key = { commands[i].frame, commands[i].arguments[0], commands[i].arguments[1], commands[i].arguments[2] };
+      view_keys.push_back(key);
+    }
+  }
+
+  // Context before the renderers, they create gl resources
+  OffscreenContext offscreen;
+
+  if (!create_offscreen_context(width, height, offscreen))
+    return 1;
+
+  // GLEW has to be built with EGL support (GLEW_EGL) to load without GLX
+  glewExperimental = GL_TRUE;
+
+  if (GLEW_OK != glewInit())
+  {
+    std::cerr << "'glewInit()' failed." << std::endl;
+    return 1;
+  }
+
+  // Graph
+  std::chrono::steady_clock::time_point load_start = std::chrono::steady_clock::now();
+
+  vta::Visualization* graph = new vta::Visualization();
+  graph->create_graph_from_db(argv[1], argv[2]);
+
+  std::cout << "Loaded " << graph->get_node_num() << " nodes, " << graph->get_edge_num() << " edges, "
+            << graph->get_cluster_num() << " clusters in "
+            << std::chrono::duration<double>(std::chrono::steady_clock::now() - load_start).count() << " s" << std::endl;
+
+  vta::OverviewRenderer* overview_renderer = new vta::OverviewRenderer(graph);
+
+  if (!overview_renderer->initialize())
+  {
+    std::cerr << "error initializing main vis" << std::endl;
+    return 1;
+  }
+
+  overview_renderer->resize(width, height);
+
+  vta::DetailRenderer* detail_renderer = new vta::DetailRenderer(graph);
+
+  if (!detail_renderer->initialize())
+  {
+    std::cerr << "error initializing cluster vis" << std::endl;
+    return 1;
+  }
+
+  detail_renderer->resize(width, height);
+  detail_renderer->set_filter(overview_renderer->get_filter());
+
+  vta::FrameProfiler& profiler = vta::FrameProfiler::get();
+
+  // Percentiles of every frame, not only of the default window
+  profiler.set_window_size(frame_num);
+
+  if (!csv_path.empty())
+    profiler.open_csv(csv_path);
+
+  // Frame loop, glFinish() makes the cpu time of a frame include the gpu work
+  unsigned i_command = 0;
+
+  // Nodes and edges actually drawn, over all frames
+  double drawn_node_num = 0.0;
+  double drawn_edge_num = 0.0;
+
+  std::chrono::steady_clock::time_point run_start = std::chrono::steady_clock::now();
+
+  for (unsigned frame = 0; frame != frame_num; ++frame)
+  {
+    profiler.begin_frame();
+
+    for (; i_command != commands.size() && commands[i_command].frame <= frame; ++i_command)
+    {
+      Command const& command = commands[i_command];
+      double argument = command.arguments.empty() ? 0.0 : command.arguments[0];
+
+      if (command.name == "min_similarity")
+        overview_renderer->set_minimum_similarity(argument);
+      else if (command.name == "max_similarity")
+        overview_renderer->set_maximum_similarity(argument);
+      else if (command.name == "min_degree")
+        overview_renderer->get_filter()->set_node_predicate("degree", vta::FilterEngine::degree_range((unsigned) argument, ~0u));
+      else if (command.name == "detail")
+        graph->_detail_view_cluster_index = std::min((unsigned) argument, graph->get_cluster_num() - 1);
+      else if (command.name == "key")
+        overview_renderer->keyPress((int) argument, 0);
+      else if (command.name != "view")
+        std::cerr << "Unknown command in frame " << command.frame << ": " << command.name << std::endl;
+    }
+
+    if (!view_keys.empty())
+    {
+      double scale, x, y;
+      interpolate_view(view_keys, frame, scale, x, y);
+
+      overview_renderer->set_view(scale, x, y);
+    }
+
+    {
+      vta::FrameProfiler::CpuScope cpu_scope("overview");
+      overview_renderer->display();
+      glFinish();
+    }
+
+    drawn_node_num += overview_renderer->get_drawn_node_num();
+    drawn_edge_num += overview_renderer->get_drawn_edge_num();
+
+    if (!dump_directory.empty())
+      dump_frame(frame_path(dump_directory, "overview", frame), width, height);
+
+    if (render_detail)
+    {
+      {
+        vta::FrameProfiler::CpuScope cpu_scope("detail");
+        vta::FrameProfiler::GpuScope gpu_scope("detail");
+        detail_renderer->display();
+        glFinish();
+      }
+
+      drawn_node_num += detail_renderer->get_drawn_node_num();
+      drawn_edge_num += detail_renderer->get_drawn_edge_num();
+
+      if (!dump_directory.empty())
+        dump_frame(frame_path(dump_directory, "detail", frame), width, height);
+    }
+
+    profiler.end_frame();
+  }
+
+  double run_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+
+  // Report
+  std::vector<vta::FrameProfiler::Statistics> statistics = profiler.get_statistics();
+
+  std::cout << std::endl
+            << std::left << std::setw(24) << "section" << std::right
+            << std::setw(6)  << "type"
+            << std::setw(12) << "p50 ms"
+            << std::setw(12) << "p95 ms"
+            << std::setw(12) << "p99 ms" << std::endl;
+
+  for (unsigned i = 0; i != statistics.size(); ++i)
+  {
+    vta::FrameProfiler::Statistics const& entry = statistics[i];
+
+    std::cout << std::left << std::setw(24) << entry.name << std::right
+              << std::setw(6)  << (entry.gpu ? "gpu" : "cpu")
+              << std::setw(12) << std::setprecision(4) << entry.p50
+              << std::setw(12) << std::setprecision(4) << entry.p95
+              << std::setw(12) << std::setprecision(4) << entry.p99 << std::endl;
+  }
+
+  std::cout << std::endl
+            << frame_num << " frames in " << run_time << " s, "
+            << frame_num / run_time << " frames/s, "
+            << drawn_node_num / run_time << " drawn nodes/s, "
+            << drawn_edge_num / run_time << " drawn edges/s" << std::endl;
+
+  profiler.close_csv();
+
+  delete detail_renderer;
+  delete overview_renderer;
+  delete graph;
+
+  destroy_offscreen_context(offscreen);
+
+  return 0;
+}
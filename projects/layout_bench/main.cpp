@@ -0,0 +1,118 @@
+// vta
+#include <layout/LayoutKernels.hpp>
+
+// cpp includes
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Reference placement as done before the kernels (double cos/sin per node)
+  \remarks ...
+*/
+
+void reference_circle(std::vector<double>& x, std::vector<double>& y, unsigned count, double radius)
+{
+  double angle = (M_PI * 2.0)/count;
+
+  for (unsigned i_node = 0; i_node != count; ++i_node)
+  {
+    x[i_node] = cos(angle * i_node) * radius;
+    y[i_node] = sin(angle * i_node) * radius;
+  }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Runs a function repeatedly and returns the best time in seconds
+  \remarks ...
+*/
+
+template <typename Function>
+double measure(Function function, unsigned repetitions)
+{
+  double best = 1e30;
+
+  for (unsigned i = 0; i != repetitions; ++i)
+  {
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    function();
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+    best = std::min(best, std::chrono::duration<double>(end - start).count());
+  }
+
+  return best;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+int main(int argc, char *argv[])
+{
+  unsigned max_count = 10000000;
+
+  if (argc > 1)
+    max_count = atoi(argv[1]);
+
+  std::cout << std::setw(10) << "nodes"
+            << std::setw(16) << "reference n/s"
+            << std::setw(16) << "circle n/s"
+            << std::setw(16) << "rings n/s"
+            << std::setw(16) << "max error" << std::endl;
+
+  for (unsigned count = 1000; count <= max_count; count *= 10)
+  {
+    unsigned repetitions = std::max(3u, 10000000 / count);
+    float radius = 100.0f * count;
+
+    std::vector<double> reference_x(count);
+    std::vector<double> reference_y(count);
+    std::vector<float> x(count);
+    std::vector<float> y(count);
+
+    double reference_time = measure([&]() { reference_circle(reference_x, reference_y, count, radius); }, repetitions);
+    double circle_time = measure([&]() { vta::LayoutKernels::circle(x.data(), y.data(), count, radius); }, repetitions);
+
+    // Deviation relative to the radius
+    double max_error = 0.0;
+
+    for (unsigned i = 0; i != count; ++i)
+    {
+      max_error = std::max(max_error, fabs(x[i] - reference_x[i]) / radius);
+      max_error = std::max(max_error, fabs(y[i] - reference_y[i]) / radius);
+    }
+
+    // Five rings, nodes assigned round robin
+    const unsigned ring_num = 5;
+    std::vector<unsigned> node_ring(count);
+    float ring_radius[ring_num];
+
+    for (unsigned i = 0; i != count; ++i)
+      node_ring[i] = i % ring_num;
+
+    for (unsigned i = 0; i != ring_num; ++i)
+      ring_radius[i] = radius * (i + 1) / ring_num;
+
+    double rings_time = measure([&]() { vta::LayoutKernels::rings(node_ring.data(), count, ring_radius, ring_num, x.data(), y.data()); }, repetitions);
+
+    std::cout << std::setw(10) << count
+              << std::setw(16) << std::setprecision(4) << count / reference_time
+              << std::setw(16) << std::setprecision(4) << count / circle_time
+              << std::setw(16) << std::setprecision(4) << count / rings_time
+              << std::setw(16) << std::setprecision(3) << max_error << std::endl;
+  }
+
+  return 0;
+}
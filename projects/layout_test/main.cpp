@@ -0,0 +1,104 @@
+// vta
+#include <layout/LayoutGraph.hpp>
+#include <layout/PivotMds.hpp>
+#include <layout/ForceLayout.hpp>
+#include <layout/MultilevelLayout.hpp>
+
+// cpp includes
+#include <vector>
+#include <set>
+#include <utility>
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Star graph: node 0 is the hub, all others are its leaves
+  \remarks ...
+*/
+
+vta::LayoutGraph make_star(unsigned node_num)
+{
+  std::vector<unsigned> sources;
+  std::vector<unsigned> targets;
+  std::vector<float> weights;
+
+  for (unsigned i_node = 1; i_node != node_num; ++i_node)
+  {
+    sources.push_back(0);
+    targets.push_back(i_node);
+    weights.push_back(0.95f);
+  }
+
+  return vta::LayoutGraph::from_edges(node_num, sources, targets, weights);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Number of distinct positions
+  \remarks ...
+*/
+
+unsigned count_distinct(std::vector<float> const& x, std::vector<float> const& y)
+{
+  std::set<std::pair<float, float> > positions;
+
+  for (unsigned i = 0; i != x.size(); ++i)
+    positions.insert(std::make_pair(x[i], y[i]));
+
+  return positions.size();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Checks that no layout stacks structurally equivalent nodes
+  \remarks Returns 1 if a layout puts two nodes of a star on the same point
+*/
+
+int main(int argc, char *argv[])
+{
+  unsigned node_num = 2001;
+
+  if (argc > 1)
+    node_num = atoi(argv[1]);
+
+  vta::LayoutGraph star = make_star(node_num);
+
+  std::vector<float> x;
+  std::vector<float> y;
+
+  unsigned distinct[3];
+
+  vta::PivotMds(star).run(x, y, 100.0f);
+  distinct[0] = count_distinct(x, y);
+
+  vta::ForceLayout(star).run(x, y, 100.0f);
+  distinct[1] = count_distinct(x, y);
+
+  vta::MultilevelLayout(star).run(x, y, 100.0f);
+  distinct[2] = count_distinct(x, y);
+
+  char const* names[3] = { "pivot mds", "pivot mds + force", "multilevel" };
+
+  int result = 0;
+
+  std::cout << "star with " << node_num << " nodes, distinct positions:" << std::endl;
+
+  for (unsigned i = 0; i != 3; ++i)
+  {
+    std::cout << std::setw(20) << names[i] << std::setw(10) << distinct[i]
+              << (distinct[i] == node_num ? "" : "  FAILED") << std::endl;
+
+    if (distinct[i] != node_num)
+      result = 1;
+  }
+
+  return result;
+}
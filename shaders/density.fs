@@ -0,0 +1,44 @@
+#version 330
+
+///////////////////////////////////////////////////////////////////
+
+// input layout definitions
+
+layout ( location = 0 ) out vec4 FragColor;
+
+
+///////////////////////////////////////////////////////////////////
+
+// uniforms
+
+// Summed edge weights per pixel
+uniform sampler2D Density;
+
+// Gradient lookup, density 0 left and saturated right
+uniform sampler2D Gradient;
+
+// Density scale of the tone mapping
+uniform float Exposure;
+
+///////////////////////////////////////////////////////////////////
+
+// input/output definitions
+
+in vec2 tex_coord;
+
+///////////////////////////////////////////////////////////////////
+
+// implementation
+
+void main()
+{
+  float density = texture(Density, tex_coord).r;
+
+  if (density <= 0.0)
+    discard;
+
+  // Bounded tone mapping, never saturates completely
+  float value = 1.0 - exp(-density * Exposure);
+
+  FragColor = texture(Gradient, vec2(value, 0.5));
+}
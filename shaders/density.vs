@@ -0,0 +1,23 @@
+#version 330
+
+///////////////////////////////////////////////////////////////////
+
+// Full screen triangle, no attributes
+
+///////////////////////////////////////////////////////////////////
+
+// output
+
+out vec2 tex_coord;
+
+///////////////////////////////////////////////////////////////////
+
+// implementation
+
+void main()
+{
+  // (0, 0), (2, 0), (0, 2)
+  tex_coord = vec2((gl_VertexID & 1) != 0 ? 2.0 : 0.0, (gl_VertexID & 2) != 0 ? 2.0 : 0.0);
+
+  gl_Position = vec4(tex_coord * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -7,11 +7,23 @@
 layout ( location = 0 ) out vec4 FragColor;
 
 
+///////////////////////////////////////////////////////////////////
+
+// uniforms
+
+// Similarity window of the displayed edges
+uniform float MinSimilarity;
+uniform float MaxSimilarity;
+
+// Write the weight for density accumulation (see DensityRenderer)
+uniform int DensityMode;
+
 ///////////////////////////////////////////////////////////////////
 
 // input/output definitions
 
 in vec3 color;
+flat in float similarity;
 
 ///////////////////////////////////////////////////////////////////
 
@@ -19,7 +31,13 @@ in vec3 color;
 
 void main()
 {
-  FragColor = vec4(color, 1.0);
+  if (similarity < MinSimilarity || similarity > MaxSimilarity)
+    discard;
+
+  if (DensityMode != 0)
+    FragColor = vec4(color.b);
+  else
+    FragColor = vec4(color, 1.0);
 //  FragColor = Color;
 //  FragColor = vec4(0.3, 0.3, 0.3, 1.0);
 }
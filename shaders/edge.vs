@@ -6,6 +6,7 @@
 
 layout (location = 0 ) in vec2 in_position;
 layout (location = 1 ) in vec3 in_color;
+layout (location = 2 ) in float in_similarity;
 
 ///////////////////////////////////////////////////////////////////
 
@@ -15,11 +16,20 @@ uniform mat4 Projection;
 uniform mat4 View;
 uniform mat4 Model;
 
+// Similarity window of the displayed edges
+uniform float MinSimilarity;
+uniform float MaxSimilarity;
+
+// Visibility bit per edge (vertices 2i and 2i+1), tested if VisibilityTest != 0
+uniform usamplerBuffer Visibility;
+uniform int VisibilityTest;
+
 ///////////////////////////////////////////////////////////////////
 
 // output
 
 out vec3 color;
+flat out float similarity;
 
 ///////////////////////////////////////////////////////////////////
 
@@ -28,5 +38,24 @@ out vec3 color;
 void main()
 {
   color = in_color;
+  similarity = in_similarity;
+
+  // Both vertices of an edge have the same similarity and visibility bit:
+  // move hidden edges out of the clip volume, they are clipped before
+  // rasterization
+  bool visible = in_similarity >= MinSimilarity && in_similarity <= MaxSimilarity;
+
+  if (visible && VisibilityTest != 0)
+  {
+    int edge = gl_VertexID / 2;
+    visible = ((texelFetch(Visibility, edge / 32).r >> uint(edge % 32)) & 1u) != 0u;
+  }
+
+  if (!visible)
+  {
+    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    return;
+  }
+
   gl_Position = Projection * View * Model * vec4(in_position, 0.0, 1.0);
 }
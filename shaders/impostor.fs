@@ -0,0 +1,27 @@
+#version 330
+
+///////////////////////////////////////////////////////////////////
+
+
+in fData
+{
+    vec4 color;
+    vec2 corner;
+}frag;
+
+
+// output
+layout ( location = 0 ) out vec4 FragColor;
+
+
+///////////////////////////////////////////////////////////////////
+
+
+void main()
+{
+  // Disc inside the quad
+  if (dot(frag.corner, frag.corner) > 1.0)
+    discard;
+
+  FragColor = frag.color;
+}
@@ -0,0 +1,52 @@
+#version 330
+
+///////////////////////////////////////////////////////////////////
+
+// attribute layout definitions
+
+// One instance per cluster, the quad corner comes from gl_VertexID
+layout (location = 0 ) in vec2 in_center;
+layout (location = 1 ) in float in_radius;
+layout (location = 2 ) in vec3 in_color;
+
+///////////////////////////////////////////////////////////////////
+
+// uniforms
+
+uniform mat4 Projection;
+uniform mat4 View;
+uniform mat4 Model;
+
+// Minimum half edge length of the quads in clip space (node size)
+uniform float NodeSize;
+
+///////////////////////////////////////////////////////////////////
+
+// output
+
+out fData
+{
+    vec4 color;
+    vec2 corner;
+}frag;
+
+
+///////////////////////////////////////////////////////////////////
+
+// implementation
+
+void main()
+{
+  frag.color = vec4(in_color, 1.0);
+
+  // Triangle strip: (-1, 1), (-1, -1), (1, 1), (1, -1)
+  frag.corner = vec2((gl_VertexID & 2) != 0 ? 1.0 : -1.0, (gl_VertexID & 1) != 0 ? -1.0 : 1.0);
+
+  mat4 mvp = Projection * View * Model;
+
+  // Radius in clip space, at least the size of a node
+  vec2 radius = max(abs((mvp * vec4(in_radius, in_radius, 0.0, 0.0)).xy), vec2(NodeSize));
+
+  gl_Position = mvp * vec4(in_center, 0.0, 1.0);
+  gl_Position.xy += frag.corner * radius * gl_Position.w;
+}
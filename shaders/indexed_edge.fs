@@ -0,0 +1,49 @@
+#version 330
+
+///////////////////////////////////////////////////////////////////
+
+// input layout definitions
+
+layout ( location = 0 ) out vec4 FragColor;
+
+
+///////////////////////////////////////////////////////////////////
+
+// input
+
+// Edge of the first line of the draw command
+flat in int first_edge;
+
+///////////////////////////////////////////////////////////////////
+
+// uniforms
+
+// Weight per edge
+uniform samplerBuffer Weights;
+
+// Visibility bit per edge, tested if VisibilityTest != 0
+uniform usamplerBuffer Visibility;
+uniform int VisibilityTest;
+
+// Write the weight for density accumulation (see DensityRenderer)
+uniform int DensityMode;
+
+///////////////////////////////////////////////////////////////////
+
+// implementation
+
+void main()
+{
+  int edge = first_edge + gl_PrimitiveID;
+
+  if (VisibilityTest != 0 && ((texelFetch(Visibility, edge / 32).r >> uint(edge % 32)) & 1u) == 0u)
+    discard;
+
+  // Same color as Edge::_color
+  float weight = texelFetch(Weights, edge).r;
+
+  if (DensityMode != 0)
+    FragColor = vec4(weight);
+  else
+    FragColor = vec4(0.0, 0.0, weight, 1.0);
+}
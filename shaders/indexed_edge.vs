@@ -0,0 +1,37 @@
+#version 330
+
+///////////////////////////////////////////////////////////////////
+
+// attribute layout definitions
+
+// Node vertex buffer, edges are drawn with an element buffer
+layout (location = 0 ) in vec2 in_position;
+
+// First index of the draw command (one instance per command)
+layout (location = 2 ) in uint in_first_index;
+
+///////////////////////////////////////////////////////////////////
+
+// uniforms
+
+uniform mat4 Projection;
+uniform mat4 View;
+uniform mat4 Model;
+
+///////////////////////////////////////////////////////////////////
+
+// output
+
+// Edge of the first line of the draw command
+flat out int first_edge;
+
+///////////////////////////////////////////////////////////////////
+
+// implementation
+
+void main()
+{
+  first_edge = int(in_first_index / 2u);
+
+  gl_Position = Projection * View * Model * vec4(in_position, 0.0, 1.0);
+}
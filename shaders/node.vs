@@ -4,9 +4,14 @@
 
 // attribute layout definitions
 
+// One instance per node, the quad corner comes from gl_VertexID
 layout (location = 0 ) in vec2 in_position;
 layout (location = 1 ) in vec3 in_color;
 
+// Index of the node in the vertex buffer, gl_InstanceID restarts with every
+// draw command and GLSL 3.30 has no gl_BaseInstance
+layout (location = 2 ) in uint in_vertex;
+
 ///////////////////////////////////////////////////////////////////
 
 // uniforms
@@ -15,14 +20,21 @@ uniform mat4 Projection;
 uniform mat4 View;
 uniform mat4 Model;
 
+// Half edge length of the node quads in clip space
+uniform float NodeSize;
+
+// Visibility bit per node, tested if VisibilityTest != 0
+uniform usamplerBuffer Visibility;
+uniform int VisibilityTest;
+
 ///////////////////////////////////////////////////////////////////
 
 // output
 
-out vData
+out fData
 {
     vec4 color;
-}vertex;
+}frag;
 
 
 ///////////////////////////////////////////////////////////////////
@@ -31,6 +43,18 @@ out vData
 
 void main()
 {
-  vertex.color = vec4(in_color, 1.0);
-  gl_Position = vec4(in_position, 0.0, 1.0);
+  frag.color = vec4(in_color, 1.0);
+
+  // Hidden nodes collapse to a point outside the clip volume
+  if (VisibilityTest != 0 && ((texelFetch(Visibility, int(in_vertex / 32u)).r >> (in_vertex % 32u)) & 1u) == 0u)
+  {
+    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    return;
+  }
+
+  // Triangle strip: (-1, 1), (-1, -1), (1, 1), (1, -1)
+  vec2 corner = vec2((gl_VertexID & 2) != 0 ? 1.0 : -1.0, (gl_VertexID & 1) != 0 ? -1.0 : 1.0);
+
+  gl_Position = Projection * View * Model * vec4(in_position, 0.0, 1.0);
+  gl_Position.xy += corner * NodeSize * gl_Position.w;
 }
@@ -0,0 +1,30 @@
+#version 330
+
+///////////////////////////////////////////////////////////////////
+
+// uniforms
+
+// Glyph coverage
+uniform sampler2D Atlas;
+
+///////////////////////////////////////////////////////////////////
+
+
+in fData
+{
+    vec4 color;
+    vec2 tex_coord;
+}frag;
+
+
+// output
+layout ( location = 0 ) out vec4 FragColor;
+
+
+///////////////////////////////////////////////////////////////////
+
+
+void main()
+{
+  FragColor = vec4(frag.color.rgb, frag.color.a * texture(Atlas, frag.tex_coord).r);
+}
@@ -0,0 +1,45 @@
+#version 330
+
+///////////////////////////////////////////////////////////////////
+
+// attribute layout definitions
+
+// One instance per glyph, the quad corner comes from gl_VertexID
+layout (location = 0 ) in vec4 in_rect;
+layout (location = 1 ) in vec4 in_tex_rect;
+layout (location = 2 ) in vec4 in_color;
+
+///////////////////////////////////////////////////////////////////
+
+// uniforms
+
+uniform mat4 Projection;
+uniform mat4 View;
+
+///////////////////////////////////////////////////////////////////
+
+// output
+
+out fData
+{
+    vec4 color;
+    vec2 tex_coord;
+}frag;
+
+
+///////////////////////////////////////////////////////////////////
+
+// implementation
+
+void main()
+{
+  frag.color = in_color;
+
+  // Triangle strip: top left, bottom left, top right, bottom right
+  vec2 corner = vec2((gl_VertexID & 2) != 0 ? 1.0 : 0.0, (gl_VertexID & 1) != 0 ? 0.0 : 1.0);
+
+  // Atlas rows run top down
+  frag.tex_coord = vec2(mix(in_tex_rect.x, in_tex_rect.z, corner.x), mix(in_tex_rect.w, in_tex_rect.y, corner.y));
+
+  gl_Position = Projection * View * vec4(mix(in_rect.xy, in_rect.zw, corner), 0.0, 1.0);
+}
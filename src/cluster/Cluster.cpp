@@ -1,11 +1,21 @@
 #include "Cluster.hpp"
 
+// vta
+#include <layout/LayoutGraph.hpp>
+#include <layout/ForceLayout.hpp>
+#include <layout/MultilevelLayout.hpp>
+#include <layout/PivotMds.hpp>
+#include <layout/LayoutKernels.hpp>
+
 namespace vta
 {
 
 
 Cluster::Cluster()
-: _nodes(),_edges(),_position_x(0.0),_position_y(0.0),_radius(0.0)
+: _nodes(),_edges(),_position_x(0.0),_position_y(0.0),_radius(0.0),_bounding_radius(0.0),
+  _node_degree(),_node_min_weight(),_node_max_weight(),_node_mean_weight(),
+  _node_weight_sum(0),_min_edge_weight(0.0f),_max_edge_weight(0.0f),_mean_edge_weight(0.0f),
+  _similarity_index()
 {}
 
 Cluster::~Cluster()
@@ -90,138 +100,296 @@ Cluster::get_radius()
 }
 
 
+void
+Cluster::update_bounding_radius()
+{
+  double max_distance_squared = 0.0;
+
+  for (unsigned i_node = 0; i_node != _nodes.size(); ++i_node)
+  {
+    double dx = _nodes[i_node]->_x - _position_x;
+    double dy = _nodes[i_node]->_y - _position_y;
+
+    max_distance_squared = std::max(max_distance_squared, dx * dx + dy * dy);
+  }
+
+  _bounding_radius = sqrt(max_distance_squared);
+}
+
+
+double
+Cluster::get_bounding_radius() const
+{
+  return _bounding_radius;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // Layouts
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 /**
-  \brief   Creates a radial layout
-  \remarks
+  \brief   Node positions of the cluster relative to its center
 */
 
-void
-Cluster::make_radial_layout()
+static void
+get_local_positions(Cluster* cluster, std::vector<float>& x, std::vector<float>& y)
 {
-  double node_size = 100.0;
-  unsigned node_num = _nodes.size();
+  unsigned node_num = cluster->get_node_num();
 
-  // Compute angle according to number of nodes
-  double angle = (M_PI * 2.0)/node_num;
+  x.resize(node_num);
+  y.resize(node_num);
 
   for (unsigned i_node = 0; i_node != node_num; ++i_node)
   {
-    Node* current_node = _nodes[i_node];
+    Node* current_node = cluster->get_node(i_node);
 
-    current_node->_x = (cos(angle * i_node) * _radius) + _position_x;
-    current_node->_y = (sin(angle * i_node) * _radius) + _position_y;
+    x[i_node] = current_node->_x - cluster->get_position_x();
+    y[i_node] = current_node->_y - cluster->get_position_y();
+  }
+}
+
+
+/**
+  \brief   Moves positions relative to the center back to the nodes
+*/
+
+static void
+set_local_positions(Cluster* cluster, std::vector<float> const& x, std::vector<float> const& y)
+{
+  for (unsigned i_node = 0; i_node != cluster->get_node_num(); ++i_node)
+  {
+    Node* current_node = cluster->get_node(i_node);
+
+    current_node->_x = x[i_node] + cluster->get_position_x();
+    current_node->_y = y[i_node] + cluster->get_position_y();
   }
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+
+
+/**
+  \brief   Creates a radial layout
+  \remarks ...
+*/
+
+void
+Cluster::make_radial_layout()
+{
+  std::vector<float> x;
+  std::vector<float> y;
+
+  get_local_positions(this, x, y);
+  make_radial_layout(x, y, _radius);
+  set_local_positions(this, x, y);
+}
+
+
+void
+Cluster::make_radial_layout(std::vector<float>& x, std::vector<float>& y, float radius)
+{
+  LayoutKernels::circle(x.data(), y.data(), _nodes.size(), radius);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
   \brief   Creates a ring layout
-  \remarks
-  \remarks
+  \remarks Nodes are put into the inner ring until half of the cluster's node
+           weight is reached, the others are sorted into the outer rings by
+           their maximum edge weight.
+  \remarks Needs compute_statistics() to be called before
 */
 
 void
 Cluster::make_ring_layout()
 {
-  double node_size = 100.0; // Member variable?
+  std::vector<float> x;
+  std::vector<float> y;
+
+  get_local_positions(this, x, y);
+  make_ring_layout(x, y, _radius);
+  set_local_positions(this, x, y);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Ring layout around (0,0)
+  \remarks Nodes that fall into no ring keep their position
+*/
 
+void
+Cluster::make_ring_layout(std::vector<float>& x, std::vector<float>& y, float radius)
+{
   unsigned number_of_rings = 5; // Member variable?
 
-  // Radius that changes with every ring
-  double local_radius = _radius;
+  double radius_step = radius / number_of_rings;
 
-  double radius_step = _radius / number_of_rings;
+  unsigned node_num = _nodes.size();
+
+  // Ring of every node, 0 is the inner ring and number_of_rings means not placed
+  std::vector<unsigned> node_ring(node_num, number_of_rings);
+
+  double min_edge_weigth = 0.9; // Minimum edge weight of subset
+  double max_edge_weight = 1.0; // Maximum edge weight of subset
 
-  // Fill inner and outer ring
-  std::vector<Node*> inner_ring;
-  std::vector<Node*> outer_rings;
+  double step_width = (max_edge_weight - min_edge_weigth)/(number_of_rings-1);
 
-  // Fill according to sum of node weights of cluster and inner ring
-  unsigned cluster_node_weight_sum = get_node_weight_sum();
   unsigned inner_ring_node_weight_sum = 0;
 
-  for (unsigned i_node = 0; i_node != _nodes.size(); ++i_node)
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
   {
-    Node* current_node = _nodes[i_node];
+    if (inner_ring_node_weight_sum >= _node_weight_sum * 0.5)
+    {
+      double weight = _node_max_weight[i_node];
+
+      // Outer ring with weight in [min + i * step, min + (i+1) * step)
+      int i_ring = floor((weight - min_edge_weigth) / step_width);
 
-    if (inner_ring_node_weight_sum >= cluster_node_weight_sum * 0.5)
-      outer_rings.push_back(current_node);
+      if (weight < min_edge_weigth + (i_ring * step_width))
+        --i_ring;
+      else if (weight >= min_edge_weigth + ((i_ring+1) * step_width))
+        ++i_ring;
 
+      if (i_ring >= 0 && i_ring < (int) number_of_rings-1)
+        node_ring[i_node] = i_ring + 1;
+    }
     else
-      inner_ring.push_back(current_node);
+      node_ring[i_node] = 0;
 
-    inner_ring_node_weight_sum += current_node->getDegree();
+    inner_ring_node_weight_sum += _node_degree[i_node];
   }
 
-  // Draw inner ring
-  double angle = (M_PI * 2.0)/inner_ring.size();
+  // Radius of every ring, the inner ring is the outermost circle
+  std::vector<float> ring_radius(number_of_rings, 0.0f);
 
+  ring_radius[0] = radius_step * (number_of_rings+1);
 
-  local_radius = radius_step * (number_of_rings+1);
+  for (unsigned i_ring = 1; i_ring != number_of_rings; ++i_ring)
+    ring_radius[i_ring] = radius_step * (i_ring+1);
 
-  for (unsigned i_node = 0; i_node != inner_ring.size(); ++i_node)
+  std::vector<float> ring_x(node_num);
+  std::vector<float> ring_y(node_num);
+
+  LayoutKernels::rings(node_ring.data(), node_num, ring_radius.data(), number_of_rings, ring_x.data(), ring_y.data());
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
   {
-    Node* current_node = inner_ring[i_node];
+    if (node_ring[i_node] == number_of_rings)
+      continue;
 
-    current_node->_x = (cos(angle * i_node) * local_radius) + _position_x;
-    current_node->_y = (sin(angle * i_node) * local_radius) + _position_y;
+    x[i_node] = ring_x[i_node];
+    y[i_node] = ring_y[i_node];
   }
+}
 
-  // Draw outer rings
-  double min_edge_weigth = 0.9; // Minimum edge weight of subset
-  double max_edge_weight = 1.0; // Maximum edge weight of subset
 
-  double step_width = (max_edge_weight - min_edge_weigth)/(number_of_rings-1);
+////////////////////////////////////////////////////////////////////////////////
 
-  for (unsigned i_ring = 0; i_ring != number_of_rings-1; ++i_ring)
-  {
-    double ring_edge_weight_min = min_edge_weigth + (i_ring * step_width);
-    double ring_edge_weight_max = min_edge_weigth + ((i_ring+1) * step_width);
+/**
+  \brief   Creates a force directed layout
+  \remarks Starts from the pivot MDS layout, edges attract by similarity,
+           repulsion uses a Barnes-Hut quadtree
+*/
+
+void
+Cluster::make_force_layout()
+{
+  std::vector<float> x;
+  std::vector<float> y;
 
-    std::vector<Node*> current_ring;
+  get_local_positions(this, x, y);
+  make_force_layout(x, y, _radius);
+  set_local_positions(this, x, y);
+}
 
-    for (unsigned i_node = 0; i_node != outer_rings.size(); ++i_node)
-    {
-      Node* current_node = outer_rings[i_node];
 
-      double max_edge_weight = get_max_edge_weight(current_node);
+void
+Cluster::make_force_layout(std::vector<float>& x, std::vector<float>& y, float radius)
+{
+  if (_nodes.empty())
+    return;
 
-      if (max_edge_weight >= ring_edge_weight_min && max_edge_weight < ring_edge_weight_max)
-      {
-        current_ring.push_back(current_node);
-      }
-    }
+  LayoutGraph graph = LayoutGraph::from_cluster(this);
 
-    local_radius = radius_step * (i_ring+2);
+  PivotMds(graph).run(x, y, radius);
 
-    angle = (M_PI * 2.0)/current_ring.size();
+  ForceLayout force_layout(graph);
+  force_layout.run(x, y, radius);
+}
 
-    for (unsigned i_node = 0; i_node != current_ring.size(); ++i_node)
-    {
-      Node* current_node = current_ring[i_node];
 
-      current_node->_x = (cos(angle * i_node) * local_radius) + _position_x;
-      current_node->_y = (sin(angle * i_node) * local_radius) + _position_y;
-    }
-  }
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Creates a multilevel force directed layout
+  \remarks For large clusters: coarsens by heavy edge matching, lays out the
+           coarsest graph and refines level by level
+*/
+
+void
+Cluster::make_multilevel_layout()
+{
+  std::vector<float> x;
+  std::vector<float> y;
+
+  get_local_positions(this, x, y);
+  make_multilevel_layout(x, y, _radius);
+  set_local_positions(this, x, y);
 }
 
 
-unsigned
-Cluster::get_node_weight_sum()
+void
+Cluster::make_multilevel_layout(std::vector<float>& x, std::vector<float>& y, float radius)
 {
-  unsigned node_weight_sum = 0;
+  if (_nodes.empty())
+    return;
 
-  for (unsigned i = 0; i != _nodes.size(); ++i)
-    node_weight_sum += _nodes[i]->getDegree();
+  LayoutGraph graph = LayoutGraph::from_cluster(this);
 
-  return node_weight_sum;
+  MultilevelLayout multilevel_layout(graph);
+  multilevel_layout.run(x, y, radius);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Creates a pivot MDS layout
+  \remarks Shortest path distances to a few pivots projected to 2D, linear
+           time and no iterations
+*/
+
+void
+Cluster::make_pivot_mds_layout()
+{
+  std::vector<float> x;
+  std::vector<float> y;
+
+  get_local_positions(this, x, y);
+  make_pivot_mds_layout(x, y, _radius);
+  set_local_positions(this, x, y);
+}
+
+
+void
+Cluster::make_pivot_mds_layout(std::vector<float>& x, std::vector<float>& y, float radius)
+{
+  LayoutGraph graph = LayoutGraph::from_cluster(this);
+
+  PivotMds(graph).run(x, y, radius);
+}
+
+
+unsigned
+Cluster::get_node_weight_sum() const
+{
+  return _node_weight_sum;
 }
 
 void
@@ -262,53 +430,147 @@ Cluster::create_default_cluster()
 // Allgemeine Layout Funktionen fuer edge-weights
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
-double
-Cluster::get_max_edge_weight(Node* v1)
+/**
+  \brief   Computes degree and min/max/mean edge weight of every node and of
+           the whole cluster
+  \remarks Call after clustering; layouts read from these arrays instead of
+           scanning the adjacency again
+*/
+
+void
+Cluster::compute_statistics()
 {
+  unsigned node_num = _nodes.size();
+
+  _node_degree.assign(node_num, 0);
+  _node_min_weight.assign(node_num, 0.0f);
+  _node_max_weight.assign(node_num, 0.0);
+  _node_mean_weight.assign(node_num, 0.0f);
+
+  _node_weight_sum = 0;
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+  {
+    Node* current_node = _nodes[i_node];
+
+    double min_edge_weight = 1.1;
+    double max_edge_weight = 0.0;
+    double sum_edge_weight = 0.0;
+
+    for (unsigned i_edge = 0; i_edge != current_node->outgoingEdges.size(); ++i_edge)
+    {
+      double weight = current_node->outgoingEdges[i_edge]->getWeight();
+
+      min_edge_weight = std::min(weight, min_edge_weight);
+      max_edge_weight = std::max(weight, max_edge_weight);
+      sum_edge_weight += weight;
+    }
+
+    for (unsigned i_edge = 0; i_edge != current_node->incomingEdges.size(); ++i_edge)
+    {
+      double weight = current_node->incomingEdges[i_edge]->getWeight();
+
+      min_edge_weight = std::min(weight, min_edge_weight);
+      max_edge_weight = std::max(weight, max_edge_weight);
+      sum_edge_weight += weight;
+    }
+
+    unsigned degree = current_node->getDegree();
+
+    _node_degree[i_node] = degree;
+    _node_max_weight[i_node] = max_edge_weight;
+
+    if (degree != 0)
+    {
+      _node_min_weight[i_node] = min_edge_weight;
+      _node_mean_weight[i_node] = sum_edge_weight / degree;
+    }
+
+    _node_weight_sum += degree;
+  }
+
+  // Cluster statistics over the edges of the cluster
+  double min_edge_weight = 1.1;
   double max_edge_weight = 0.0;
+  double sum_edge_weight = 0.0;
+
+  for (unsigned i_edge = 0; i_edge != _edges.size(); ++i_edge)
+  {
+    double weight = _edges[i_edge]->getWeight();
+
+    min_edge_weight = std::min(weight, min_edge_weight);
+    max_edge_weight = std::max(weight, max_edge_weight);
+    sum_edge_weight += weight;
+  }
+
+  _max_edge_weight = max_edge_weight;
+  _min_edge_weight = _edges.empty() ? 0.0f : min_edge_weight;
+  _mean_edge_weight = _edges.empty() ? 0.0f : sum_edge_weight / _edges.size();
+}
 
-  for(unsigned i_edge = 0; i_edge != v1->outgoingEdges.size(); ++i_edge)
-    max_edge_weight = std::max(v1->outgoingEdges[i_edge]->getWeight(), max_edge_weight);
 
-  for(unsigned i_edge = 0; i_edge != v1->incomingEdges.size(); ++i_edge)
-    max_edge_weight = std::max(v1->incomingEdges[i_edge]->getWeight(), max_edge_weight);
+unsigned
+Cluster::get_node_degree(unsigned index) const
+{
+  return _node_degree[index];
+}
 
-  return max_edge_weight;
+float
+Cluster::get_node_min_weight(unsigned index) const
+{
+  return _node_min_weight[index];
 }
 
 double
-Cluster::get_min_edge_weight(Node* v1)
+Cluster::get_node_max_weight(unsigned index) const
 {
-  double min_edge_weight = 1.1;
+  return _node_max_weight[index];
+}
 
-  for(unsigned i_edge = 0; i_edge != v1->outgoingEdges.size(); ++i_edge)
-    min_edge_weight = std::min(v1->outgoingEdges[i_edge]->getWeight(), min_edge_weight);
+float
+Cluster::get_node_mean_weight(unsigned index) const
+{
+  return _node_mean_weight[index];
+}
 
-  for(unsigned i_edge = 0; i_edge != v1->incomingEdges.size(); ++i_edge)
-    min_edge_weight = std::min(v1->incomingEdges[i_edge]->getWeight(), min_edge_weight);
 
-  return min_edge_weight;
+float
+Cluster::get_min_edge_weight() const
+{
+  return _min_edge_weight;
 }
 
-double
-Cluster::get_average_edge_weight(Node* v1)
+float
+Cluster::get_max_edge_weight() const
 {
-  double sum_edge_weight = 0.0;
-  unsigned num_of_edges = 0;
+  return _max_edge_weight;
+}
 
-  for(unsigned i_edge = 0; i_edge != v1->outgoingEdges.size(); ++i_edge)
-  {
-    sum_edge_weight += v1->outgoingEdges[i_edge]->getWeight();
-    num_of_edges++;
-  }
+float
+Cluster::get_mean_edge_weight() const
+{
+  return _mean_edge_weight;
+}
 
-  for(unsigned i_edge = 0; i_edge != v1->incomingEdges.size(); ++i_edge)
-  {
-    sum_edge_weight += v1->incomingEdges[i_edge]->getWeight();
-    num_of_edges++;
-  }
 
-  return sum_edge_weight/num_of_edges;
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Sort the edges of the cluster into similarity buckets
+  \remarks ...
+*/
+
+void
+Cluster::build_similarity_index()
+{
+  _similarity_index.build(_edges);
+}
+
+
+SimilarityIndex const&
+Cluster::get_similarity_index() const
+{
+  return _similarity_index;
 }
 
 
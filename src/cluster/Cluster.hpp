@@ -3,6 +3,7 @@
 
 // vta
 #include <cluster/Visualization.hpp>
+#include <cluster/SimilarityIndex.hpp>
 
 namespace vta
 {
@@ -36,12 +37,46 @@ namespace vta
       void set_radius(double);
       double get_radius();
 
+      // Distance of the farthest node from the position, the extent of the
+      // current layout (layouts may reach beyond the radius)
+      void update_bounding_radius();
+      double get_bounding_radius() const;
+
       // Layout functions
       void make_radial_layout();
       void make_ring_layout();
-
-      // Compute sum of all node weights
-      unsigned get_node_weight_sum();
+      void make_force_layout();
+      void make_multilevel_layout();
+      void make_pivot_mds_layout();
+
+      // Layout functions on positions around (0,0) in node order, they only
+      // read nodes, edges and statistics and may run off the render thread
+      void make_radial_layout(std::vector<float>&, std::vector<float>&, float);
+      void make_ring_layout(std::vector<float>&, std::vector<float>&, float);
+      void make_force_layout(std::vector<float>&, std::vector<float>&, float);
+      void make_multilevel_layout(std::vector<float>&, std::vector<float>&, float);
+      void make_pivot_mds_layout(std::vector<float>&, std::vector<float>&, float);
+
+      // Compute per-node and per-cluster edge statistics in one pass
+      void compute_statistics();
+
+      // Per-node statistics (same index as get_node)
+      unsigned get_node_degree(unsigned) const;
+      float get_node_min_weight(unsigned) const;
+      double get_node_max_weight(unsigned) const;
+      float get_node_mean_weight(unsigned) const;
+
+      // Cluster statistics
+      float get_min_edge_weight() const;
+      float get_max_edge_weight() const;
+      float get_mean_edge_weight() const;
+
+      // Sum of all node weights (degrees)
+      unsigned get_node_weight_sum() const;
+
+      // Edges of the cluster sorted by similarity
+      void build_similarity_index();
+      SimilarityIndex const& get_similarity_index() const;
 
       // Create a default cluster
       void create_default_cluster();
@@ -55,11 +90,23 @@ namespace vta
       double _position_y;
       // Radius
       double _radius;
-
-      // Radial layout weight functions
-      double get_max_edge_weight(Node*);
-      double get_min_edge_weight(Node*);
-      double get_average_edge_weight(Node*);
+      double _bounding_radius;
+
+      // Per-node statistics, filled by compute_statistics()
+      std::vector<unsigned> _node_degree;
+      std::vector<float> _node_min_weight;
+      // Double like the edge weights, ring boundaries are compared with it
+      std::vector<double> _node_max_weight;
+      std::vector<float> _node_mean_weight;
+
+      // Cluster statistics
+      unsigned _node_weight_sum;
+      float _min_edge_weight;
+      float _max_edge_weight;
+      float _mean_edge_weight;
+
+      // Similarity buckets of the cluster edges
+      SimilarityIndex _similarity_index;
   };
 
 
@@ -14,6 +14,7 @@ Node::Node(long index, std::string label, Article article)
    incomingEdges(),
 
    _index(index),
+   _id(0),
 
    _x(0.0),
    _y(0.0),
@@ -37,6 +38,7 @@ Node::Node(long index, double x, double y, std::string label)
    incomingEdges(),
 
    _index(index),
+   _id(0),
 
    _x(x),
    _y(y),
@@ -53,6 +53,9 @@ namespace vta
     // New index
     long _index;    //TODO uint32_t !!!
 
+    // Position in the node vector of the Visualization
+    unsigned _id;
+
     // Label (Article Name)
     std::string _label;
 
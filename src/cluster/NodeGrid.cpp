@@ -0,0 +1,267 @@
+#include "NodeGrid.hpp"
+
+// vta
+#include <cluster/Cluster.hpp>
+
+// cpp
+#include <algorithm>
+#include <cmath>
+
+
+namespace vta
+{
+
+namespace
+{
+  // Nodes per cell on average
+  const double NODES_PER_CELL = 2.0;
+}
+
+
+NodeGrid::NodeGrid()
+ : _cluster(nullptr),
+   _node_num(0),
+   _min_x(0.0),
+   _min_y(0.0),
+   _cell_size(1.0),
+   _width(1),
+   _height(1),
+   _cell_offsets(2, 0),
+   _cell_nodes(),
+   _cell_node_x(),
+   _cell_node_y()
+{}
+
+
+NodeGrid::~NodeGrid()
+{}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Sorts the nodes of a cluster into the grid
+  \remarks Counting sort by cell, the cell size gives about NODES_PER_CELL
+           nodes per cell on the bounding box of the nodes
+*/
+
+void
+NodeGrid::build(Cluster* cluster)
+{
+  _cluster = cluster;
+  _node_num = cluster->get_node_num();
+
+  if (_node_num == 0)
+  {
+    _width = 1;
+    _height = 1;
+    _cell_offsets.assign(2, 0);
+    _cell_nodes.clear();
+    _cell_node_x.clear();
+    _cell_node_y.clear();
+    return;
+  }
+
+  double min_x = cluster->get_node(0)->_x;
+  double min_y = cluster->get_node(0)->_y;
+  double max_x = min_x;
+  double max_y = min_y;
+
+  for (unsigned i = 1; i != _node_num; ++i)
+  {
+    Node* current_node = cluster->get_node(i);
+
+    min_x = std::min(min_x, current_node->_x);
+    min_y = std::min(min_y, current_node->_y);
+    max_x = std::max(max_x, current_node->_x);
+    max_y = std::max(max_y, current_node->_y);
+  }
+
+  double extent_x = max_x - min_x;
+  double extent_y = max_y - min_y;
+
+  // Square cells, all nodes at one position give a single cell
+  double area = std::max(extent_x * extent_y, std::max(extent_x, extent_y) * std::max(extent_x, extent_y) / _node_num);
+
+  _cell_size = area > 0.0 ? sqrt(area * NODES_PER_CELL / _node_num) : 1.0;
+
+  _min_x = min_x;
+  _min_y = min_y;
+  _width  = std::max(1u, std::min(_node_num, (unsigned) (extent_x / _cell_size) + 1));
+  _height = std::max(1u, std::min(_node_num, (unsigned) (extent_y / _cell_size) + 1));
+
+  std::vector<unsigned> node_cells(_node_num);
+
+  _cell_offsets.assign(_width * _height + 1, 0);
+
+  for (unsigned i = 0; i != _node_num; ++i)
+  {
+    Node* current_node = cluster->get_node(i);
+
+    unsigned cell_x = std::min(_width - 1,  (unsigned) ((current_node->_x - _min_x) / _cell_size));
+    unsigned cell_y = std::min(_height - 1, (unsigned) ((current_node->_y - _min_y) / _cell_size));
+
+    node_cells[i] = cell_y * _width + cell_x;
+    ++_cell_offsets[node_cells[i] + 1];
+  }
+
+  for (unsigned i_cell = 0; i_cell != _width * _height; ++i_cell)
+    _cell_offsets[i_cell + 1] += _cell_offsets[i_cell];
+
+  std::vector<unsigned> next(_cell_offsets.begin(), _cell_offsets.end() - 1);
+
+  _cell_nodes.resize(_node_num);
+  _cell_node_x.resize(_node_num);
+  _cell_node_y.resize(_node_num);
+
+  for (unsigned i = 0; i != _node_num; ++i)
+  {
+    unsigned slot = next[node_cells[i]]++;
+
+    _cell_nodes[slot] = i;
+    _cell_node_x[slot] = cluster->get_node(i)->_x;
+    _cell_node_y[slot] = cluster->get_node(i)->_y;
+  }
+}
+
+
+Cluster*
+NodeGrid::get_cluster() const
+{
+  return _cluster;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Finds the nearest node within a distance
+  \remarks Searches rings of cells around the cell of the point. Nodes
+           outside ring r are at least r cells away, the search stops when
+           the best node is closer or the rings leave the distance.
+*/
+
+unsigned
+NodeGrid::find_nearest(double x, double y, double max_distance) const
+{
+  unsigned nearest = _node_num;
+
+  if (_node_num == 0)
+    return nearest;
+
+  double best = max_distance * max_distance;
+
+  int center_x = std::max(0, std::min((int) _width - 1,  (int) floor((x - _min_x) / _cell_size)));
+  int center_y = std::max(0, std::min((int) _height - 1, (int) floor((y - _min_y) / _cell_size)));
+
+  // Distance from the point to the grid, rings closer than that are empty
+  double outside_x = std::max(0.0, std::max(_min_x - x, x - (_min_x + _width * _cell_size)));
+  double outside_y = std::max(0.0, std::max(_min_y - y, y - (_min_y + _height * _cell_size)));
+
+  if (outside_x * outside_x + outside_y * outside_y > best)
+    return nearest;
+
+  int max_ring = std::max(_width, _height);
+
+  for (int ring = 0; ring <= max_ring; ++ring)
+  {
+    // Nodes of this and later rings are at least (ring - 1) cells away
+    double ring_distance = std::max(0, ring - 1) * _cell_size;
+
+    if (ring_distance * ring_distance > best)
+      break;
+
+    for (int cell_y = center_y - ring; cell_y <= center_y + ring; ++cell_y)
+    {
+      if (cell_y < 0 || cell_y >= (int) _height)
+        continue;
+
+      // Only the border of the ring
+      bool border_row = (cell_y == center_y - ring || cell_y == center_y + ring);
+      int step = border_row ? 1 : 2 * ring;
+
+      for (int cell_x = center_x - ring; cell_x <= center_x + ring; cell_x += std::max(1, step))
+      {
+        if (cell_x < 0 || cell_x >= (int) _width)
+          continue;
+
+        unsigned i_cell = cell_y * _width + cell_x;
+
+        for (unsigned slot = _cell_offsets[i_cell]; slot != _cell_offsets[i_cell + 1]; ++slot)
+        {
+          double dx = _cell_node_x[slot] - x;
+          double dy = _cell_node_y[slot] - y;
+          double distance = dx * dx + dy * dy;
+
+          if (distance <= best)
+          {
+            best = distance;
+            nearest = _cell_nodes[slot];
+          }
+        }
+      }
+    }
+  }
+
+  return nearest;
+}
+
+
+void
+NodeGrid::find_in_radius(double x, double y, double radius, std::vector<unsigned>& nodes) const
+{
+  nodes.clear();
+
+  if (_node_num == 0)
+    return;
+
+  unsigned min_cell_x, max_cell_x, min_cell_y, max_cell_y;
+
+  get_cell_range(x - radius, x + radius, _min_x, _width,  min_cell_x, max_cell_x);
+  get_cell_range(y - radius, y + radius, _min_y, _height, min_cell_y, max_cell_y);
+
+  for (unsigned cell_y = min_cell_y; cell_y < max_cell_y; ++cell_y)
+  {
+    for (unsigned cell_x = min_cell_x; cell_x < max_cell_x; ++cell_x)
+    {
+      unsigned i_cell = cell_y * _width + cell_x;
+
+      for (unsigned slot = _cell_offsets[i_cell]; slot != _cell_offsets[i_cell + 1]; ++slot)
+      {
+        double dx = _cell_node_x[slot] - x;
+        double dy = _cell_node_y[slot] - y;
+
+        if (dx * dx + dy * dy <= radius * radius)
+          nodes.push_back(_cell_nodes[slot]);
+      }
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Cells [first, end) along one axis overlapping [min, max]
+  \remarks Empty if the interval misses the grid
+*/
+
+void
+NodeGrid::get_cell_range(double min, double max, double grid_min, unsigned cell_num,
+                         unsigned& first, unsigned& end) const
+{
+  double grid_max = grid_min + cell_num * _cell_size;
+
+  if (max < grid_min || min > grid_max)
+  {
+    first = 0;
+    end = 0;
+    return;
+  }
+
+  first = (unsigned) std::max(0.0, floor((min - grid_min) / _cell_size));
+  end   = std::min(cell_num, (unsigned) floor((max - grid_min) / _cell_size) + 1);
+}
+
+
+} // namespace vta
@@ -0,0 +1,65 @@
+#ifndef NODE_GRID_HPP
+#define NODE_GRID_HPP
+
+// cpp
+#include <vector>
+
+
+namespace vta
+{
+
+  class Cluster;
+
+
+  // Uniform grid over the node positions of a cluster, about two nodes per
+  // cell. Nodes are sorted by cell (compressed like a csr graph) and their
+  // positions are copied in that order, a query only touches the cells
+  // around the point. Positions are read at build(), the grid has to be
+  // rebuilt after a layout.
+
+  class NodeGrid
+  {
+    public:
+      // Class constructor
+      NodeGrid();
+
+      // Class destructor
+      ~NodeGrid();
+
+      // Sort the nodes of the cluster into the grid
+      void build(Cluster*);
+
+      Cluster* get_cluster() const;
+
+      // Nearest node (index in the cluster) within a distance, the number of
+      // nodes of the cluster if there is none
+      unsigned find_nearest(double, double, double) const;
+
+      // All nodes within a distance (x, y, radius)
+      void find_in_radius(double, double, double, std::vector<unsigned>&) const;
+
+    private:
+      Cluster* _cluster;
+      unsigned _node_num;
+
+      // Grid bounds
+      double _min_x;
+      double _min_y;
+      double _cell_size;
+      unsigned _width;
+      unsigned _height;
+
+      // Nodes of cell i are _cell_nodes[_cell_offsets[i]] .. _cell_nodes[_cell_offsets[i+1]-1]
+      std::vector<unsigned> _cell_offsets;
+      std::vector<unsigned> _cell_nodes;
+      std::vector<double> _cell_node_x;
+      std::vector<double> _cell_node_y;
+
+      // Cell range covering [min, max] along one axis, clamped to the grid
+      void get_cell_range(double, double, double, unsigned, unsigned&, unsigned&) const;
+  };
+
+
+} // Namespace vta
+
+#endif // NODE_GRID_HPP
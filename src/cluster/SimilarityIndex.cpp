@@ -0,0 +1,163 @@
+#include "SimilarityIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace vta
+{
+
+
+SimilarityIndex::SimilarityIndex()
+ : _edges(), _offsets(BUCKET_NUM + 1, 0)
+{}
+
+
+SimilarityIndex::~SimilarityIndex()
+{}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Counting sort edges into BUCKET_NUM similarity buckets
+  \remarks Edges inside a bucket keep their original order
+*/
+
+void
+SimilarityIndex::build(std::vector<Edge*> const& edges)
+{
+  std::vector<unsigned> bucket_size(BUCKET_NUM, 0);
+
+  for (unsigned i_edge = 0; i_edge != edges.size(); ++i_edge)
+    ++bucket_size[get_bucket(edges[i_edge]->getWeight())];
+
+  // Prefix sums
+  _offsets.assign(BUCKET_NUM + 1, 0);
+
+  for (unsigned i_bucket = 0; i_bucket != BUCKET_NUM; ++i_bucket)
+    _offsets[i_bucket+1] = _offsets[i_bucket] + bucket_size[i_bucket];
+
+  // Scatter
+  std::vector<unsigned> insert_position(_offsets.begin(), _offsets.end() - 1);
+
+  _edges.assign(edges.size(), nullptr);
+
+  for (unsigned i_edge = 0; i_edge != edges.size(); ++i_edge)
+  {
+    Edge* current_edge = edges[i_edge];
+
+    _edges[insert_position[get_bucket(current_edge->getWeight())]++] = current_edge;
+  }
+}
+
+
+unsigned
+SimilarityIndex::get_edge_num() const
+{
+  return _edges.size();
+}
+
+
+Edge*
+SimilarityIndex::get_edge(unsigned index) const
+{
+  return _edges[index];
+}
+
+
+unsigned
+SimilarityIndex::get_bucket_offset(unsigned bucket) const
+{
+  return _offsets[bucket];
+}
+
+
+unsigned
+SimilarityIndex::get_range_begin(double min_similarity) const
+{
+  return _offsets[get_first_bucket(min_similarity)];
+}
+
+
+unsigned
+SimilarityIndex::get_range_end(double max_similarity) const
+{
+  return _offsets[get_end_bucket(max_similarity)];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Returns the bucket of an edge weight
+  \remarks Weights are similarity/1000, weights >= 1.0 go into the last bucket
+*/
+
+/*static*/
+unsigned
+SimilarityIndex::get_bucket(double weight)
+{
+  long bucket = lround(weight * BUCKET_NUM);
+
+  if (bucket < 0)
+    return 0;
+
+  if (bucket >= (long) BUCKET_NUM)
+    return BUCKET_NUM - 1;
+
+  return bucket;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   First bucket whose weight is >= min_similarity
+  \remarks Uses the same double comparison as testing the edge weight directly
+*/
+
+/*static*/
+unsigned
+SimilarityIndex::get_first_bucket(double min_similarity)
+{
+  long bucket = ceil(min_similarity * BUCKET_NUM);
+
+  bucket = std::max(0L, std::min(bucket, (long) BUCKET_NUM));
+
+  while (bucket > 0 && (bucket-1) / (double) BUCKET_NUM >= min_similarity)
+    --bucket;
+
+  while (bucket < (long) BUCKET_NUM && bucket / (double) BUCKET_NUM < min_similarity)
+    ++bucket;
+
+  return bucket;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   One past the last bucket whose weight is <= max_similarity
+  \remarks ...
+*/
+
+/*static*/
+unsigned
+SimilarityIndex::get_end_bucket(double max_similarity)
+{
+  long bucket = floor(max_similarity * BUCKET_NUM) + 1;
+
+  bucket = std::max(0L, std::min(bucket, (long) BUCKET_NUM));
+
+  while (bucket > 0 && (bucket-1) / (double) BUCKET_NUM > max_similarity)
+    --bucket;
+
+  while (bucket < (long) BUCKET_NUM && bucket / (double) BUCKET_NUM <= max_similarity)
+    ++bucket;
+
+  return bucket;
+}
+
+
+}
@@ -0,0 +1,60 @@
+#ifndef SIMILARITY_INDEX_HPP
+#define SIMILARITY_INDEX_HPP
+
+// vta
+#include <cluster/Edge.hpp>
+
+// cpp
+#include <vector>
+
+
+namespace vta
+{
+
+  class Edge;
+
+
+  class SimilarityIndex
+  {
+    public:
+      // Similarity is stored with 10 bit (0-999) in the data base
+      static const unsigned BUCKET_NUM = 1000;
+
+      // Class constructor
+      SimilarityIndex();
+
+      // Class destructor
+      ~SimilarityIndex();
+
+      // Counting sort edges into similarity buckets
+      void build(std::vector<Edge*> const&);
+
+      // Get number of edges and edge in sorted order
+      unsigned get_edge_num() const;
+      Edge* get_edge(unsigned) const;
+
+      // First edge of a bucket (BUCKET_NUM gives the end of the last bucket)
+      unsigned get_bucket_offset(unsigned) const;
+
+      // Range of sorted edges with min <= similarity <= max
+      unsigned get_range_begin(double) const;
+      unsigned get_range_end(double) const;
+
+      // Bucket of an edge weight
+      static unsigned get_bucket(double);
+
+      // First bucket with similarity >= min, one past last bucket with similarity <= max
+      static unsigned get_first_bucket(double);
+      static unsigned get_end_bucket(double);
+
+    private:
+      // Edges sorted by similarity
+      std::vector<Edge*> _edges;
+      // Prefix sums of the bucket sizes (BUCKET_NUM + 1 entries)
+      std::vector<unsigned> _offsets;
+  };
+
+
+} // Namespace vta
+
+#endif // SIMILARITY_INDEX_HPP
@@ -1,5 +1,8 @@
 #include "Visualization.hpp"
 
+// vta
+#include <util/ThreadPool.hpp>
+
 
 
 
@@ -24,8 +27,18 @@ Visualization::Visualization()
 
   _clusters(),
 
+  _similarity_index(),
+
   _clusters_per_row(20),
-  _cluster_size(0)
+  _cluster_size(0),
+
+  _packing(SHELF_PACKING),
+  _shelves(),
+  _cell_min_x(),
+  _cell_size(),
+  _cell_margin(0.0),
+
+  _layout_version(0)
 {}
 
 
@@ -53,6 +66,7 @@ Visualization::create_node(long index, std::string const label, Article article)
 {
   Node* newNode = new Node(index, label, article);
 
+  newNode->_id = _nodes.size();
   _nodes.push_back(newNode);
 
   return newNode;
@@ -184,8 +198,15 @@ Visualization::node_map_contains_id(int id)
 }
 
 
-// Compare two clusters according to their size
-bool cluster_compare_func (Cluster* i, Cluster* j) { return (i->get_node_num() > j->get_node_num()); }
+// Compare two clusters according to their size, equal sizes by the id of
+// their first node, so the order never depends on the sort
+bool cluster_compare_func (Cluster* i, Cluster* j)
+{
+  if (i->get_node_num() != j->get_node_num())
+    return i->get_node_num() > j->get_node_num();
+
+  return i->get_node(0)->_id < j->get_node(0)->_id;
+}
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -275,10 +296,15 @@ Visualization::create_graph_from_db(const char g_bin_data_filename[], const char
     }
 
       search_clusters();
-      std::sort (_clusters.begin(), _clusters.end(), cluster_compare_func);
+
+      // Sorted once, cluster indices stay valid for the whole session
+      std::stable_sort (_clusters.begin(), _clusters.end(), cluster_compare_func);
 
       set_cluster_positions();
 
+      compute_cluster_statistics();
+      build_similarity_indices();
+
       std::cout << "created from db" << std::endl;
   }
 
@@ -286,8 +312,8 @@ Visualization::create_graph_from_db(const char g_bin_data_filename[], const char
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
-  \brief   Returns the size of every cluster
-  \remarks All clusters currently have the same size
+  \brief   Returns the cell size of the biggest cluster
+  \remarks With GRID_PACKING all clusters have this size
 */
 
 double
@@ -379,8 +405,37 @@ Visualization::search_clusters()
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
-  \brief   Set all cluster positions according to the radius of the biggest cluster
-  \remarks
+  \brief   Set how clusters are arranged
+  \remarks Takes effect with the next set_cluster_positions()
+*/
+
+void
+Visualization::set_cluster_packing(Packing packing)
+{
+  _packing = packing;
+}
+
+
+Visualization::Packing
+Visualization::get_cluster_packing() const
+{
+  return _packing;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Set all cluster positions and radii
+  \remarks GRID_PACKING: every cluster gets the cell of the biggest cluster,
+           _clusters_per_row cells per row.
+           SHELF_PACKING: every cluster gets a cell sized by its own radius,
+           cells are put on shelves (rows) of about the square root of the
+           total cell area. Clusters are sorted by size at load, so the first
+           cell of a shelf is its highest. The cluster order is kept, stored
+           cluster indices stay valid.
+  \remarks Nodes that already have a layout are moved and scaled with their
+           cluster
 */
 
 void
@@ -388,37 +443,384 @@ Visualization::set_cluster_positions()
 {
   std::cout << _clusters.size() << std::endl;
 
-  std::sort (_clusters.begin(), _clusters.end(), cluster_compare_func);
+  _shelves.clear();
+  _cell_min_x.assign(_clusters.size(), 0.0);
+  _cell_size.assign(_clusters.size(), 0.0);
+
+  if (_clusters.empty())
+    return;
 
   double node_size = 100.0;
 
-  // All cluster have the size and radius of the biggest cluster
-  double width_height = node_size * sqrt(_clusters[0]->get_node_num());
-  double radius = node_size * _clusters[0]->get_node_num() + width_height;
+  // Radius of every cluster
+  std::vector<double> radius(_clusters.size());
+  double total_cell_area = 0.0;
+
+  for (unsigned i_cluster = 0; i_cluster != _clusters.size(); ++i_cluster)
+  {
+    unsigned node_num = (_packing == GRID_PACKING) ? _clusters[0]->get_node_num() : _clusters[i_cluster]->get_node_num();
+
+    double width_height = node_size * sqrt(node_num);
+    radius[i_cluster] = node_size * node_num + width_height;
+
+    // Cell with margin of radius/2
+    _cell_size[i_cluster] = (radius[i_cluster] * 2) + radius[i_cluster]/2;
+    total_cell_area += _cell_size[i_cluster] * _cell_size[i_cluster];
+  }
 
   // Set Cluster size
-  _cluster_size = (radius * 2) + radius/2;
+  _cluster_size = _cell_size[0];
+
+  double row_width = _cluster_size * _clusters_per_row;
+
+  if (_packing == SHELF_PACKING)
+    row_width = std::max(sqrt(total_cell_area), _cluster_size);
 
   // Das erste Cluster soll von 0 bis "_cluster_size" reichen
-  double position_x = radius;
-  double position_y = radius;
+  double position_x = 0.0;
+  double position_y = 0.0;
+
+  Shelf shelf;
+  shelf.min_y = 0.0;
+  shelf.max_y = _cell_size[0];
+  shelf.first_cluster = 0;
 
   for (unsigned i_cluster = 0; i_cluster != _clusters.size(); ++i_cluster)
   {
+    double cell_size = _cell_size[i_cluster];
+
+    // Start the next shelf
+    bool row_full = (_packing == GRID_PACKING) ? (i_cluster != 0 && i_cluster % _clusters_per_row == 0)
+                                               : (position_x != 0.0 && position_x + cell_size > row_width);
+
+    if (row_full)
+    {
+      shelf.end_cluster = i_cluster;
+      _shelves.push_back(shelf);
+
+      position_x = 0.0;
+      position_y = shelf.max_y;
+
+      shelf.min_y = position_y;
+      shelf.max_y = position_y + cell_size;
+      shelf.first_cluster = i_cluster;
+    }
+
     Cluster* current_cluster = _clusters[i_cluster];
 
+    double old_x = current_cluster->get_position_x();
+    double old_y = current_cluster->get_position_y();
+    double old_radius = current_cluster->get_radius();
+
     // Set position and radius
-    current_cluster->set_position(position_x, position_y);
-    current_cluster->set_radius(radius);
+    current_cluster->set_position(position_x + radius[i_cluster], position_y + radius[i_cluster]);
+    current_cluster->set_radius(radius[i_cluster]);
+
+    // Move an existing layout with its cluster
+    if (old_radius > 0.0)
+    {
+      double scale = radius[i_cluster] / old_radius;
+
+      for (unsigned i_node = 0; i_node != current_cluster->get_node_num(); ++i_node)
+      {
+        Node* current_node = current_cluster->get_node(i_node);
+
+        current_node->_x = current_cluster->get_position_x() + (current_node->_x - old_x) * scale;
+        current_node->_y = current_cluster->get_position_y() + (current_node->_y - old_y) * scale;
+      }
+    }
+
+    _cell_min_x[i_cluster] = position_x;
 
     // Set position for the next cluster
-    position_x += (radius * 2) + radius/2;
-    if (i_cluster % _clusters_per_row == _clusters_per_row-1) // _cluster_per_row inital 20
+    position_x += cell_size;
+  }
+
+  shelf.end_cluster = _clusters.size();
+  _shelves.push_back(shelf);
+
+  increment_layout_version();
+
+  std::cout << "Packed clusters into " << _shelves.size() << " rows, world size "
+            << row_width << " x " << _shelves.back().max_y << std::endl;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Index of the cluster whose bounding circle contains the point, or
+           else whose cell contains it
+  \remarks Layouts can reach out of their cells, so the bounding circles near
+           the point are tested first, the closest center relative to its
+           radius wins. Otherwise a binary search over the shelves and inside
+           the shelf, O(log n).
+*/
+
+unsigned
+Visualization::get_cluster_index_at(double x, double y) const
+{
+  unsigned not_found = _clusters.size();
+
+  std::vector<unsigned> candidates;
+  get_clusters_in_rect(x, y, x, y, candidates);
+
+  unsigned closest = not_found;
+  double closest_distance = 1.0;
+
+  for (unsigned i = 0; i != candidates.size(); ++i)
+  {
+    Cluster* cluster = _clusters[candidates[i]];
+
+    double radius = cluster->get_bounding_radius();
+
+    if (radius <= 0.0)
+      continue;
+
+    double dx = x - cluster->get_position_x();
+    double dy = y - cluster->get_position_y();
+
+    double distance = sqrt(dx * dx + dy * dy) / radius;
+
+    if (distance <= closest_distance)
     {
-      position_x = radius;
-      position_y += (radius * 2) + radius/2;
+      closest = candidates[i];
+      closest_distance = distance;
     }
   }
+
+  if (closest != not_found)
+    return closest;
+
+  // First shelf that ends above y
+  unsigned begin = 0;
+  unsigned end = _shelves.size();
+
+  while (begin < end)
+  {
+    unsigned middle = (begin + end) / 2;
+
+    if (_shelves[middle].max_y <= y)
+      begin = middle + 1;
+    else
+      end = middle;
+  }
+
+  if (begin == _shelves.size() || y < _shelves[begin].min_y)
+    return not_found;
+
+  Shelf const& shelf = _shelves[begin];
+
+  // Last cell of the shelf that starts left of x
+  std::vector<double>::const_iterator cell = std::upper_bound(_cell_min_x.begin() + shelf.first_cluster,
+                                                              _cell_min_x.begin() + shelf.end_cluster, x);
+
+  if (cell == _cell_min_x.begin() + shelf.first_cluster)
+    return not_found;
+
+  unsigned index = (cell - _cell_min_x.begin()) - 1;
+
+  // Cells of smaller clusters do not fill the shelf height
+  if (x >= _cell_min_x[index] + _cell_size[index] || y >= shelf.min_y + _cell_size[index])
+    return not_found;
+
+  return index;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Indices of all clusters whose cells or bounding circles intersect
+           the rectangle
+  \remarks Only shelves and cells in the range widened by _cell_margin are
+           visited, they are tested with the box of the cell and the box of
+           the bounding circle
+*/
+
+void
+Visualization::get_clusters_in_rect(double min_x, double min_y, double max_x, double max_y,
+                                    std::vector<unsigned>& clusters) const
+{
+  clusters.clear();
+
+  for (unsigned i_shelf = 0; i_shelf != _shelves.size(); ++i_shelf)
+  {
+    Shelf const& shelf = _shelves[i_shelf];
+
+    if (shelf.max_y + _cell_margin <= min_y)
+      continue;
+
+    if (shelf.min_y - _cell_margin >= max_y)
+      break;
+
+    // A cell reaches at most _cell_margin into the next one
+    std::vector<double>::const_iterator first = std::upper_bound(_cell_min_x.begin() + shelf.first_cluster,
+                                                                 _cell_min_x.begin() + shelf.end_cluster, min_x - _cell_margin);
+
+    unsigned index = first - _cell_min_x.begin();
+
+    if (index != shelf.first_cluster)
+      --index;
+
+    for (; index != shelf.end_cluster && _cell_min_x[index] - _cell_margin < max_x; ++index)
+    {
+      bool cell_overlaps = _cell_min_x[index] < max_x && _cell_min_x[index] + _cell_size[index] > min_x &&
+                           shelf.min_y < max_y && shelf.min_y + _cell_size[index] > min_y;
+
+      Cluster* cluster = _clusters[index];
+
+      double radius = cluster->get_bounding_radius();
+      double x = cluster->get_position_x();
+      double y = cluster->get_position_y();
+
+      bool circle_overlaps = x - radius < max_x && x + radius > min_x && y - radius < max_y && y + radius > min_y;
+
+      if (cell_overlaps || circle_overlaps)
+        clusters.push_back(index);
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Layout a single cluster
+  \remarks ...
+*/
+
+static void
+make_cluster_layout(Cluster* cluster, Visualization::Layout layout)
+{
+  switch (layout)
+  {
+    case Visualization::RADIAL_LAYOUT:     cluster->make_radial_layout();     break;
+    case Visualization::RING_LAYOUT:       cluster->make_ring_layout();       break;
+    case Visualization::FORCE_LAYOUT:      cluster->make_force_layout();      break;
+    case Visualization::MULTILEVEL_LAYOUT: cluster->make_multilevel_layout(); break;
+    case Visualization::PIVOT_MDS_LAYOUT:  cluster->make_pivot_mds_layout();  break;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Layout all clusters on the work stealing thread pool
+  \remarks Cluster sizes follow a power law: the many tiny clusters are
+           batched into tasks of about LAYOUT_BATCH_NODES nodes, the few giant
+           clusters get a task each and split their work internally
+*/
+
+void
+Visualization::make_layout(Layout layout)
+{
+  const unsigned LAYOUT_BATCH_NODES = 8192;
+
+  std::vector<ThreadPool::Task> tasks;
+
+  unsigned batch_begin = 0;
+  unsigned batch_nodes = 0;
+
+  for (unsigned i_cluster = 0; i_cluster != _clusters.size(); ++i_cluster)
+  {
+    batch_nodes += _clusters[i_cluster]->get_node_num();
+
+    if (batch_nodes >= LAYOUT_BATCH_NODES || i_cluster == _clusters.size() - 1)
+    {
+      unsigned batch_end = i_cluster + 1;
+
+      tasks.push_back([this, layout, batch_begin, batch_end]()
+      {
+        for (unsigned i = batch_begin; i != batch_end; ++i)
+          make_cluster_layout(_clusters[i], layout);
+      });
+
+      batch_begin = batch_end;
+      batch_nodes = 0;
+    }
+  }
+
+  ThreadPool::get().run(tasks);
+
+  increment_layout_version();
+}
+
+
+unsigned
+Visualization::get_layout_version() const
+{
+  return _layout_version;
+}
+
+
+void
+Visualization::increment_layout_version()
+{
+  ++_layout_version;
+
+  // Bounding circles against the cells
+  _cell_margin = 0.0;
+
+  for (unsigned i_shelf = 0; i_shelf != _shelves.size(); ++i_shelf)
+  {
+    Shelf const& shelf = _shelves[i_shelf];
+
+    for (unsigned i_cluster = shelf.first_cluster; i_cluster != shelf.end_cluster; ++i_cluster)
+    {
+      Cluster* cluster = _clusters[i_cluster];
+      cluster->update_bounding_radius();
+
+      double radius = cluster->get_bounding_radius();
+      double x = cluster->get_position_x();
+      double y = cluster->get_position_y();
+
+      _cell_margin = std::max(_cell_margin, std::max(_cell_min_x[i_cluster] - (x - radius),
+                                                     (x + radius) - (_cell_min_x[i_cluster] + _cell_size[i_cluster])));
+      _cell_margin = std::max(_cell_margin, std::max(shelf.min_y - (y - radius),
+                                                     (y + radius) - (shelf.min_y + _cell_size[i_cluster])));
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Compute per-node and per-cluster edge statistics of all clusters
+  \remarks Has to be called after clustering and before the first layout
+*/
+
+void
+Visualization::compute_cluster_statistics()
+{
+  for (unsigned i_cluster = 0; i_cluster != _clusters.size(); ++i_cluster)
+    _clusters[i_cluster]->compute_statistics();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Counting sort all edges and the edges of every cluster by similarity
+  \remarks A similarity window then maps to a contiguous range of edges
+*/
+
+void
+Visualization::build_similarity_indices()
+{
+  _similarity_index.build(_edges);
+
+  for (unsigned i_cluster = 0; i_cluster != _clusters.size(); ++i_cluster)
+    _clusters[i_cluster]->build_similarity_index();
+}
+
+
+SimilarityIndex const&
+Visualization::get_similarity_index() const
+{
+  return _similarity_index;
 }
 
 
@@ -4,6 +4,7 @@
 // vta
 #include <cluster/Edge.hpp>
 #include <cluster/Cluster.hpp>
+#include <cluster/SimilarityIndex.hpp>
 
 // cpp
 #include <vector>
@@ -73,9 +74,14 @@ namespace vta
       void create_graph_from_db(const char input_file_name[], const char offset_file_name[]); // replace durch get cluster
 
       // Get cluster size
-      double get_cluster_size() const; // Allgemeine Cluster size
+      double get_cluster_size() const; // Groesste Cluster size
       // Get amount of clusters per row
-      unsigned get_clusters_per_row_num() const; // wichtig fuer cluster index bei mouse over
+      unsigned get_clusters_per_row_num() const; // nur fuer GRID_PACKING
+
+      // Index of the cluster whose bounding circle (or else cell) contains the point, get_cluster_num() if there is none
+      unsigned get_cluster_index_at(double, double) const;
+      // Indices of all clusters whose cells or bounding circles intersect the rectangle (min x, min y, max x, max y)
+      void get_clusters_in_rect(double, double, double, double, std::vector<unsigned>&) const;
 
       // Index of Cluster that will be displayed in the detail view
       unsigned _detail_view_cluster_index; // wichtig fuer Cluster window
@@ -84,9 +90,32 @@ namespace vta
       void visit_node(Node*, Cluster*); /// delete
       void search_clusters(); /// delete
 
+      // Cluster arrangement: uniform grid of the biggest cluster or shelves sized per cluster
+      enum Packing { GRID_PACKING, SHELF_PACKING };
+      void set_cluster_packing(Packing);
+      Packing get_cluster_packing() const;
+
       // Set all cluster position
       void set_cluster_positions();
 
+      // Cluster layouts
+      enum Layout { RADIAL_LAYOUT, RING_LAYOUT, FORCE_LAYOUT, MULTILEVEL_LAYOUT, PIVOT_MDS_LAYOUT };
+
+      // Layout all clusters on the thread pool
+      void make_layout(Layout);
+
+      // Counter that changes whenever node positions change, for caches of
+      // positions, also updates the bounding radii of the clusters
+      unsigned get_layout_version() const;
+      void increment_layout_version();
+
+      // Compute edge statistics of all clusters
+      void compute_cluster_statistics();
+
+      // Sort all edges and the edges of every cluster by similarity
+      void build_similarity_indices();
+      SimilarityIndex const& get_similarity_index() const;
+
     private:
       std::vector<Node*> _nodes; /// delete
       std::vector<Edge*> _edges; /// delete
@@ -96,10 +125,35 @@ namespace vta
       // Clustering
       std::vector<Cluster*> _clusters;
 
+      // All edges sorted by similarity
+      SimilarityIndex _similarity_index;
+
       // Amount of clusters per row
       unsigned _clusters_per_row;
       double _cluster_size;
 
+      // Cluster arrangement
+      Packing _packing;
+
+      // Row of cells, clusters [first_cluster, end_cluster) from left to right
+      struct Shelf
+      {
+        double min_y;
+        double max_y;
+        unsigned first_cluster;
+        unsigned end_cluster;
+      };
+
+      // Shelves from bottom to top and the cell of every cluster
+      std::vector<Shelf> _shelves;
+      std::vector<double> _cell_min_x;
+      std::vector<double> _cell_size;
+
+      // Farthest a bounding circle reaches out of its cell
+      double _cell_margin;
+
+      unsigned _layout_version;
+
       //
       bool node_map_contains_id(int); /// delete
 
@@ -0,0 +1,139 @@
+#include "AhoCorasick.hpp"
+
+#include <queue>
+
+
+namespace vta
+{
+
+
+AhoCorasick::AhoCorasick()
+ : _patterns(), _transitions(256, 0), _accepting(1, 0)
+{}
+
+
+AhoCorasick::~AhoCorasick()
+{}
+
+
+void
+AhoCorasick::add_pattern(std::string const& pattern)
+{
+  _patterns.push_back(pattern);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Builds the trie of all patterns and turns it into a DFA
+  \remarks Missing transitions are resolved through the failure links, so
+           matching needs exactly one table lookup per byte of text
+*/
+
+void
+AhoCorasick::compile()
+{
+  // Trie, 0 means no transition (the root can never be a target)
+  _transitions.assign(256, 0);
+  _accepting.assign(1, 0);
+
+  for (unsigned i_pattern = 0; i_pattern != _patterns.size(); ++i_pattern)
+  {
+    std::string const& pattern = _patterns[i_pattern];
+
+    unsigned state = 0;
+
+    for (unsigned i = 0; i != pattern.size(); ++i)
+    {
+      unsigned char byte = pattern[i];
+
+      if (_transitions[state * 256 + byte] == 0)
+      {
+        _transitions[state * 256 + byte] = _accepting.size();
+        _transitions.resize(_transitions.size() + 256, 0);
+        _accepting.push_back(0);
+      }
+
+      state = _transitions[state * 256 + byte];
+    }
+
+    _accepting[state] = 1;
+  }
+
+  // Breadth first over the trie, completing transitions with the failure links
+  std::vector<unsigned> failure(_accepting.size(), 0);
+  std::queue<unsigned> states;
+
+  for (unsigned byte = 0; byte != 256; ++byte)
+  {
+    unsigned next = _transitions[byte];
+
+    if (next != 0)
+      states.push(next);
+  }
+
+  while (!states.empty())
+  {
+    unsigned state = states.front();
+    states.pop();
+
+    // A state accepts if a pattern ends in any of its suffixes
+    _accepting[state] |= _accepting[failure[state]];
+
+    for (unsigned byte = 0; byte != 256; ++byte)
+    {
+      unsigned& next = _transitions[state * 256 + byte];
+
+      if (next != 0)
+      {
+        failure[next] = _transitions[failure[state] * 256 + byte];
+        states.push(next);
+      }
+      else
+      {
+        next = _transitions[failure[state] * 256 + byte];
+      }
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   True if any pattern is contained in the text
+  \remarks An empty pattern is contained in every text (like std::string::find)
+*/
+
+bool
+AhoCorasick::matches(std::string const& text) const
+{
+  if (_patterns.empty())
+    return false;
+
+  unsigned state = 0;
+
+  if (_accepting[state])
+    return true;
+
+  for (unsigned i = 0; i != text.size(); ++i)
+  {
+    state = _transitions[state * 256 + (unsigned char) text[i]];
+
+    if (_accepting[state])
+      return true;
+  }
+
+  return false;
+}
+
+
+unsigned
+AhoCorasick::get_pattern_num() const
+{
+  return _patterns.size();
+}
+
+
+}
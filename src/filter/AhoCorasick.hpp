@@ -0,0 +1,44 @@
+#ifndef AHO_CORASICK_HPP
+#define AHO_CORASICK_HPP
+
+// cpp
+#include <vector>
+#include <string>
+
+
+namespace vta
+{
+
+  class AhoCorasick
+  {
+    public:
+      // Class constructor
+      AhoCorasick();
+
+      // Class destructor
+      ~AhoCorasick();
+
+      // Add a pattern, compile() has to be called afterwards
+      void add_pattern(std::string const&);
+
+      // Build the automaton with one transition table entry per state and byte
+      void compile();
+
+      // True if any pattern is a substring of the text
+      bool matches(std::string const&) const;
+
+      // Number of patterns
+      unsigned get_pattern_num() const;
+
+    private:
+      std::vector<std::string> _patterns;
+
+      // Transition table (state * 256 + byte) and accepting states
+      std::vector<unsigned> _transitions;
+      std::vector<char> _accepting;
+  };
+
+
+} // Namespace vta
+
+#endif // AHO_CORASICK_HPP
@@ -0,0 +1,504 @@
+#include "Bitmap.hpp"
+
+// cpp
+#include <algorithm>
+#include <iterator>
+
+
+namespace vta
+{
+
+namespace
+{
+  // Containers with more values are stored as bitmap
+  const uint32_t ARRAY_MAX_SIZE = 4096;
+
+  // 2^16 bits per container
+  const uint32_t CONTAINER_WORDS = 1024;
+}
+
+
+Bitmap::Bitmap()
+ : _containers()
+{}
+
+
+Bitmap::~Bitmap()
+{}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Bitmap with all values in [begin, end)
+  \remarks ...
+*/
+
+/*static*/
+Bitmap
+Bitmap::from_range(uint32_t begin, uint32_t end)
+{
+  Bitmap bitmap;
+
+  for (uint64_t chunk_begin = begin; chunk_begin < end; )
+  {
+    uint64_t chunk_end = std::min<uint64_t>(end, ((chunk_begin >> 16) + 1) << 16);
+
+    Container container;
+    container.key = chunk_begin >> 16;
+    container.cardinality = chunk_end - chunk_begin;
+    container.words.assign(CONTAINER_WORDS, 0);
+
+    for (uint64_t value = chunk_begin; value != chunk_end; ++value)
+      container.words[(value & 0xFFFF) / 64] |= uint64_t(1) << (value % 64);
+
+    normalize(container);
+    bitmap._containers.push_back(container);
+
+    chunk_begin = chunk_end;
+  }
+
+  return bitmap;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Bitmap from a dense bitset
+  \remarks Bits at size and above are ignored
+*/
+
+/*static*/
+Bitmap
+Bitmap::from_words(std::vector<uint64_t> const& words, uint32_t size)
+{
+  Bitmap bitmap;
+
+  uint32_t word_num = std::min<uint64_t>(words.size(), (uint64_t(size) + 63) / 64);
+
+  for (uint32_t word_begin = 0; word_begin < word_num; word_begin += CONTAINER_WORDS)
+  {
+    Container container;
+    container.key = word_begin / CONTAINER_WORDS;
+    container.cardinality = 0;
+    container.words.assign(CONTAINER_WORDS, 0);
+
+    uint32_t word_end = std::min(word_num, word_begin + CONTAINER_WORDS);
+
+    for (uint32_t i_word = word_begin; i_word != word_end; ++i_word)
+    {
+      uint64_t word = words[i_word];
+
+      // Mask bits behind size
+      if (i_word == word_num - 1 && size % 64 != 0)
+        word &= (uint64_t(1) << (size % 64)) - 1;
+
+      container.words[i_word - word_begin] = word;
+      container.cardinality += __builtin_popcountll(word);
+    }
+
+    if (container.cardinality != 0)
+    {
+      normalize(container);
+      bitmap._containers.push_back(container);
+    }
+  }
+
+  return bitmap;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Add a value
+  \remarks Appending to the last container is O(1)
+*/
+
+void
+Bitmap::add(uint32_t value)
+{
+  uint16_t key = value >> 16;
+  uint16_t low = value & 0xFFFF;
+
+  std::vector<Container>::iterator it = _containers.end();
+
+  if (_containers.empty() || _containers.back().key < key)
+  {
+    Container container;
+    container.key = key;
+    container.cardinality = 0;
+    it = _containers.insert(_containers.end(), container);
+  }
+  else if (_containers.back().key == key)
+  {
+    it = _containers.end() - 1;
+  }
+  else
+  {
+    it = _containers.begin();
+
+    while (it->key < key)
+      ++it;
+
+    if (it->key != key)
+    {
+      Container container;
+      container.key = key;
+      container.cardinality = 0;
+      it = _containers.insert(it, container);
+    }
+  }
+
+  Container& container = *it;
+
+  if (!container.words.empty())
+  {
+    uint64_t bit = uint64_t(1) << (low % 64);
+
+    if (!(container.words[low / 64] & bit))
+    {
+      container.words[low / 64] |= bit;
+      ++container.cardinality;
+    }
+    return;
+  }
+
+  if (container.values.empty() || container.values.back() < low)
+  {
+    container.values.push_back(low);
+  }
+  else
+  {
+    std::vector<uint16_t>::iterator position = std::lower_bound(container.values.begin(), container.values.end(), low);
+
+    if (*position == low)
+      return;
+
+    container.values.insert(position, low);
+  }
+
+  ++container.cardinality;
+
+  if (container.cardinality > ARRAY_MAX_SIZE)
+    normalize(container);
+}
+
+
+bool
+Bitmap::contains(uint32_t value) const
+{
+  uint16_t key = value >> 16;
+  uint16_t low = value & 0xFFFF;
+
+  // Binary search for the container
+  unsigned begin = 0;
+  unsigned end = _containers.size();
+
+  while (begin < end)
+  {
+    unsigned middle = (begin + end) / 2;
+
+    if (_containers[middle].key < key)
+      begin = middle + 1;
+    else
+      end = middle;
+  }
+
+  if (begin == _containers.size() || _containers[begin].key != key)
+    return false;
+
+  Container const& container = _containers[begin];
+
+  if (!container.words.empty())
+    return (container.words[low / 64] >> (low % 64)) & 1;
+
+  return std::binary_search(container.values.begin(), container.values.end(), low);
+}
+
+
+uint32_t
+Bitmap::get_cardinality() const
+{
+  uint32_t cardinality = 0;
+
+  for (unsigned i = 0; i != _containers.size(); ++i)
+    cardinality += _containers[i].cardinality;
+
+  return cardinality;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Write the bitmap into a dense bitset
+  \remarks Values at size and above are dropped
+*/
+
+void
+Bitmap::to_words(std::vector<uint64_t>& words, uint32_t size) const
+{
+  words.assign((uint64_t(size) + 63) / 64, 0);
+
+  for (unsigned i = 0; i != _containers.size(); ++i)
+  {
+    Container const& container = _containers[i];
+
+    uint32_t base = uint32_t(container.key) << 16;
+
+    if (!container.words.empty())
+    {
+      for (uint32_t i_word = 0; i_word != CONTAINER_WORDS; ++i_word)
+      {
+        uint32_t target_word = base / 64 + i_word;
+
+        if (target_word >= words.size())
+          break;
+
+        words[target_word] = container.words[i_word];
+      }
+    }
+    else
+    {
+      for (unsigned i_value = 0; i_value != container.values.size(); ++i_value)
+      {
+        uint32_t value = base + container.values[i_value];
+
+        if (value < size)
+          words[value / 64] |= uint64_t(1) << (value % 64);
+      }
+    }
+  }
+
+  // Clear the bits behind size
+  if (size % 64 != 0 && !words.empty())
+    words.back() &= (uint64_t(1) << (size % 64)) - 1;
+}
+
+
+Bitmap
+Bitmap::operator&(Bitmap const& other) const
+{
+  return combine(*this, other, AND);
+}
+
+
+Bitmap
+Bitmap::operator|(Bitmap const& other) const
+{
+  return combine(*this, other, OR);
+}
+
+
+Bitmap
+Bitmap::operator-(Bitmap const& other) const
+{
+  return combine(*this, other, AND_NOT);
+}
+
+
+Bitmap
+Bitmap::flip(uint32_t size) const
+{
+  return from_range(0, size) - *this;
+}
+
+
+bool
+Bitmap::operator==(Bitmap const& other) const
+{
+  if (_containers.size() != other._containers.size())
+    return false;
+
+  for (unsigned i = 0; i != _containers.size(); ++i)
+  {
+    Container const& a = _containers[i];
+    Container const& b = other._containers[i];
+
+    // Representation only depends on the cardinality
+    if (a.key != b.key || a.cardinality != b.cardinality || a.values != b.values || a.words != b.words)
+      return false;
+  }
+
+  return true;
+}
+
+
+bool
+Bitmap::operator!=(Bitmap const& other) const
+{
+  return !(*this == other);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Store the container as array or bitmap, whichever is smaller
+  \remarks Empty containers have cardinality 0 and are dropped by the caller
+*/
+
+/*static*/
+void
+Bitmap::normalize(Container& container)
+{
+  if (container.cardinality > ARRAY_MAX_SIZE && container.words.empty())
+  {
+    expand(container, container.words);
+    std::vector<uint16_t>().swap(container.values);
+  }
+  else if (container.cardinality <= ARRAY_MAX_SIZE && !container.words.empty())
+  {
+    container.values.clear();
+    container.values.reserve(container.cardinality);
+
+    for (uint32_t i_word = 0; i_word != CONTAINER_WORDS; ++i_word)
+    {
+      uint64_t word = container.words[i_word];
+
+      while (word != 0)
+      {
+        container.values.push_back(i_word * 64 + __builtin_ctzll(word));
+        word &= word - 1;
+      }
+    }
+
+    std::vector<uint64_t>().swap(container.words);
+  }
+}
+
+
+/*static*/
+void
+Bitmap::expand(Container const& container, std::vector<uint64_t>& words)
+{
+  if (!container.words.empty())
+  {
+    words = container.words;
+    return;
+  }
+
+  words.assign(CONTAINER_WORDS, 0);
+
+  for (unsigned i = 0; i != container.values.size(); ++i)
+    words[container.values[i] / 64] |= uint64_t(1) << (container.values[i] % 64);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Combine two bitmaps container by container
+  \remarks ...
+*/
+
+/*static*/
+Bitmap
+Bitmap::combine(Bitmap const& a, Bitmap const& b, Operation operation)
+{
+  Bitmap result;
+
+  unsigned i_a = 0;
+  unsigned i_b = 0;
+
+  while (i_a != a._containers.size() || i_b != b._containers.size())
+  {
+    Container const* container_a = nullptr;
+    Container const* container_b = nullptr;
+
+    if (i_b == b._containers.size() ||
+        (i_a != a._containers.size() && a._containers[i_a].key < b._containers[i_b].key))
+    {
+      container_a = &a._containers[i_a++];
+    }
+    else if (i_a == a._containers.size() || b._containers[i_b].key < a._containers[i_a].key)
+    {
+      container_b = &b._containers[i_b++];
+    }
+    else
+    {
+      container_a = &a._containers[i_a++];
+      container_b = &b._containers[i_b++];
+    }
+
+    Container container;
+
+    if (combine_container(container_a, container_b, operation, container))
+      result._containers.push_back(container);
+  }
+
+  return result;
+}
+
+
+/*static*/
+bool
+Bitmap::combine_container(Container const* a, Container const* b, Operation operation, Container& result)
+{
+  result.key = a ? a->key : b->key;
+  result.cardinality = 0;
+
+  // Containers on one side only
+  if (!b)
+  {
+    if (operation == AND)
+      return false;
+
+    result = *a;
+    return true;
+  }
+
+  if (!a)
+  {
+    if (operation != OR)
+      return false;
+
+    result = *b;
+    return true;
+  }
+
+  // Two arrays
+  if (a->words.empty() && b->words.empty())
+  {
+    std::back_insert_iterator<std::vector<uint16_t> > output(result.values);
+
+    if (operation == AND)
+      std::set_intersection(a->values.begin(), a->values.end(), b->values.begin(), b->values.end(), output);
+    else if (operation == OR)
+      std::set_union(a->values.begin(), a->values.end(), b->values.begin(), b->values.end(), output);
+    else
+      std::set_difference(a->values.begin(), a->values.end(), b->values.begin(), b->values.end(), output);
+
+    result.cardinality = result.values.size();
+    normalize(result);
+
+    return result.cardinality != 0;
+  }
+
+  // At least one bitmap
+  std::vector<uint64_t> words_b;
+
+  expand(*a, result.words);
+  expand(*b, words_b);
+
+  for (uint32_t i_word = 0; i_word != CONTAINER_WORDS; ++i_word)
+  {
+    if (operation == AND)
+      result.words[i_word] &= words_b[i_word];
+    else if (operation == OR)
+      result.words[i_word] |= words_b[i_word];
+    else
+      result.words[i_word] &= ~words_b[i_word];
+
+    result.cardinality += __builtin_popcountll(result.words[i_word]);
+  }
+
+  normalize(result);
+
+  return result.cardinality != 0;
+}
+
+
+}
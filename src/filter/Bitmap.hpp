@@ -0,0 +1,81 @@
+#ifndef BITMAP_HPP
+#define BITMAP_HPP
+
+// cpp
+#include <vector>
+#include <stdint.h>
+
+
+namespace vta
+{
+
+  // Compressed bitmap in the style of roaring bitmaps: the 32 bit values are
+  // split into chunks of 2^16 by their high 16 bits, every chunk is stored as a
+  // sorted array of low 16 bits or, if it has more than 4096 values, as 1024
+  // words of 64 bit.
+
+  class Bitmap
+  {
+    public:
+      // Class constructor
+      Bitmap();
+
+      // Class destructor
+      ~Bitmap();
+
+      // Bitmap with all values in [begin, end)
+      static Bitmap from_range(uint32_t, uint32_t);
+
+      // Bitmap from a dense bitset with size bits
+      static Bitmap from_words(std::vector<uint64_t> const&, uint32_t);
+
+      // Add a value, adding in increasing order is fastest
+      void add(uint32_t);
+
+      // Test a value
+      bool contains(uint32_t) const;
+
+      // Number of values
+      uint32_t get_cardinality() const;
+
+      // Write to a dense bitset with size bits
+      void to_words(std::vector<uint64_t>&, uint32_t) const;
+
+      // Set operations
+      Bitmap operator&(Bitmap const&) const;
+      Bitmap operator|(Bitmap const&) const;
+      Bitmap operator-(Bitmap const&) const;
+
+      // Complement inside [0, size)
+      Bitmap flip(uint32_t) const;
+
+      bool operator==(Bitmap const&) const;
+      bool operator!=(Bitmap const&) const;
+
+    private:
+      enum Operation { AND, OR, AND_NOT };
+
+      struct Container
+      {
+        uint16_t key;
+        uint32_t cardinality;
+        // Sorted low bits if words is empty
+        std::vector<uint16_t> values;
+        std::vector<uint64_t> words;
+      };
+
+      // Sorted by key
+      std::vector<Container> _containers;
+
+      // Switch between array and bitmap representation by cardinality
+      static void normalize(Container&);
+      static void expand(Container const&, std::vector<uint64_t>&);
+
+      static Bitmap combine(Bitmap const&, Bitmap const&, Operation);
+      static bool combine_container(Container const*, Container const*, Operation, Container&);
+  };
+
+
+} // Namespace vta
+
+#endif // BITMAP_HPP
@@ -0,0 +1,143 @@
+#include "Blacklist.hpp"
+
+// vta
+#include <util/ThreadPool.hpp>
+
+// cpp
+#include <algorithm>
+#include <iostream>
+
+
+namespace vta
+{
+
+
+Blacklist::Blacklist(Visualization* graph)
+ : _graph(graph), _entries(), _automaton(), _visibility()
+{}
+
+
+Blacklist::~Blacklist()
+{}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Add an entry to the blacklist
+  \remarks Only the new entry is tested, and only against nodes that are
+           still visible
+*/
+
+bool
+Blacklist::add(std::string const entry)
+{
+  if (std::find(_entries.begin(), _entries.end(), entry) != _entries.end())
+    return false;
+
+  _entries.push_back(entry);
+
+  _automaton.add_pattern(entry);
+  _automaton.compile();
+
+  AhoCorasick new_entry;
+  new_entry.add_pattern(entry);
+  new_entry.compile();
+
+  hide_matching_nodes(new_entry);
+
+  return true;
+}
+
+
+bool
+Blacklist::contains(std::string const& title) const
+{
+  return _automaton.matches(title);
+}
+
+
+std::vector<std::string> const&
+Blacklist::get_entries() const
+{
+  return _entries;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Recompute the visibility of every node with all entries
+  \remarks Needed after nodes were added to the graph
+*/
+
+void
+Blacklist::update_visibility()
+{
+  unsigned node_num = _graph->get_node_num();
+
+  _visibility.assign((node_num + 63) / 64, ~uint64_t(0));
+
+  // Clear the bits behind the last node
+  if (node_num % 64 != 0)
+    _visibility.back() = (uint64_t(1) << (node_num % 64)) - 1;
+
+  hide_matching_nodes(_automaton);
+}
+
+
+bool
+Blacklist::is_visible(unsigned id) const
+{
+  return (_visibility[id / 64] >> (id % 64)) & 1;
+}
+
+
+std::vector<uint64_t> const&
+Blacklist::get_visibility() const
+{
+  return _visibility;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Clear the bit of every visible node whose title matches
+  \remarks Runs on the thread pool, every task owns a range of whole words
+*/
+
+void
+Blacklist::hide_matching_nodes(AhoCorasick const& automaton)
+{
+  if (_visibility.size() * 64 < (unsigned) _graph->get_node_num())
+  {
+    update_visibility();
+    return;
+  }
+
+  unsigned node_num = _graph->get_node_num();
+
+  ThreadPool::get().parallel_for(0, _visibility.size(), 64, [this, &automaton, node_num](unsigned word_begin, unsigned word_end)
+  {
+    for (unsigned i_word = word_begin; i_word != word_end; ++i_word)
+    {
+      uint64_t word = _visibility[i_word];
+
+      // Only test nodes that are still visible
+      while (word != 0)
+      {
+        unsigned bit = __builtin_ctzll(word);
+        word &= word - 1;
+
+        unsigned id = i_word * 64 + bit;
+
+        if (id < node_num && automaton.matches(_graph->get_node_by_index(id)->_label))
+          _visibility[i_word] &= ~(uint64_t(1) << bit);
+      }
+    }
+  });
+}
+
+
+}
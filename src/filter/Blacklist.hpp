@@ -0,0 +1,65 @@
+#ifndef BLACKLIST_HPP
+#define BLACKLIST_HPP
+
+// vta
+#include <cluster/Visualization.hpp>
+#include <filter/AhoCorasick.hpp>
+
+// cpp
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+
+namespace vta
+{
+
+  class Visualization;
+
+
+  class Blacklist
+  {
+    public:
+      // Class constructor
+      Blacklist(Visualization*);
+
+      // Class destructor
+      ~Blacklist();
+
+      // Add an entry and hide all nodes whose title contains it
+      bool add(std::string const);
+
+      // True if the title contains any entry
+      bool contains(std::string const&) const;
+
+      // All entries
+      std::vector<std::string> const& get_entries() const;
+
+      // Evaluate the complete blacklist for every node of the graph
+      void update_visibility();
+
+      // Visibility of a node (by Node::_id)
+      bool is_visible(unsigned) const;
+
+      // One bit per node, 1 means visible
+      std::vector<uint64_t> const& get_visibility() const;
+
+    private:
+      // data
+      Visualization* _graph;
+
+      // Entries and the automaton of all entries
+      std::vector<std::string> _entries;
+      AhoCorasick _automaton;
+
+      // One bit per node
+      std::vector<uint64_t> _visibility;
+
+      // Hide all visible nodes whose title is matched by the automaton
+      void hide_matching_nodes(AhoCorasick const&);
+  };
+
+
+} // Namespace vta
+
+#endif // BLACKLIST_HPP
@@ -0,0 +1,428 @@
+#include "FilterEngine.hpp"
+
+
+namespace vta
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Class constructor
+  \remarks Without predicates every node and edge is visible
+*/
+
+FilterEngine::FilterEngine(Visualization* graph)
+ : _graph(graph),
+   _predicates(),
+   _combination_dirty(true),
+   _nodes(),
+   _edges(),
+   _node_words(),
+   _edge_words(),
+   _version(0),
+   _min_similarity(0.0),
+   _max_similarity(1.0)
+{}
+
+
+FilterEngine::~FilterEngine()
+{}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Add or replace a named predicate
+  \remarks A replaced predicate keeps its position in the combination
+*/
+
+void
+FilterEngine::set_node_predicate(std::string const& name, NodePredicate predicate, Operation operation)
+{
+  Predicate& entry = get_predicate(name);
+
+  entry.on_edges = false;
+  entry.operation = operation;
+  entry.node_predicate = predicate;
+  entry.edge_predicate = EdgePredicate();
+  entry.dirty = true;
+
+  _combination_dirty = true;
+}
+
+
+void
+FilterEngine::set_edge_predicate(std::string const& name, EdgePredicate predicate, Operation operation)
+{
+  Predicate& entry = get_predicate(name);
+
+  entry.on_edges = true;
+  entry.operation = operation;
+  entry.node_predicate = NodePredicate();
+  entry.edge_predicate = predicate;
+  entry.dirty = true;
+
+  _combination_dirty = true;
+}
+
+
+void
+FilterEngine::set_node_bitmap(std::string const& name, Bitmap const& bitmap, Operation operation)
+{
+  Predicate& entry = get_predicate(name);
+
+  entry.on_edges = false;
+  entry.operation = operation;
+  entry.node_predicate = NodePredicate();
+  entry.edge_predicate = EdgePredicate();
+  entry.bitmap = bitmap;
+  entry.dirty = false;
+
+  _combination_dirty = true;
+}
+
+
+void
+FilterEngine::set_edge_bitmap(std::string const& name, Bitmap const& bitmap, Operation operation)
+{
+  Predicate& entry = get_predicate(name);
+
+  entry.on_edges = true;
+  entry.operation = operation;
+  entry.node_predicate = NodePredicate();
+  entry.edge_predicate = EdgePredicate();
+  entry.bitmap = bitmap;
+  entry.dirty = false;
+
+  _combination_dirty = true;
+}
+
+
+void
+FilterEngine::remove_predicate(std::string const& name)
+{
+  for (unsigned i = 0; i != _predicates.size(); ++i)
+  {
+    if (_predicates[i].name == name)
+    {
+      _predicates.erase(_predicates.begin() + i);
+      _combination_dirty = true;
+      return;
+    }
+  }
+}
+
+
+void
+FilterEngine::invalidate(std::string const& name)
+{
+  for (unsigned i = 0; i != _predicates.size(); ++i)
+  {
+    if (_predicates[i].name == name)
+    {
+      _predicates[i].dirty = true;
+      _combination_dirty = true;
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Recompute the bitmaps of changed predicates and combine all of them
+  \remarks Node and edge predicates are folded in insertion order starting
+           with everything visible. Edges are additionally hidden if one of
+           their nodes is hidden.
+*/
+
+bool
+FilterEngine::update()
+{
+  unsigned node_num = _graph->get_node_num();
+  unsigned edge_num = _graph->get_edge_num();
+
+  // Graph changed size since the last update
+  if (_node_words.size() != (node_num + 63) / 64 || _edge_words.size() != (edge_num + 63) / 64)
+  {
+    for (unsigned i = 0; i != _predicates.size(); ++i)
+      if (_predicates[i].node_predicate || _predicates[i].edge_predicate)
+        _predicates[i].dirty = true;
+
+    _combination_dirty = true;
+  }
+
+  if (!_combination_dirty)
+    return false;
+
+  for (unsigned i = 0; i != _predicates.size(); ++i)
+    if (_predicates[i].dirty)
+      evaluate(_predicates[i]);
+
+  Bitmap nodes = Bitmap::from_range(0, node_num);
+  Bitmap edges = Bitmap::from_range(0, edge_num);
+
+  for (unsigned i = 0; i != _predicates.size(); ++i)
+  {
+    Predicate const& predicate = _predicates[i];
+
+    Bitmap& result = predicate.on_edges ? edges : nodes;
+
+    if (predicate.operation == AND)
+      result = result & predicate.bitmap;
+    else if (predicate.operation == OR)
+      result = result | predicate.bitmap;
+    else
+      result = result - predicate.bitmap;
+  }
+
+  nodes.to_words(_node_words, node_num);
+
+  // Hide edges of hidden nodes
+  if (nodes.get_cardinality() != node_num)
+  {
+    Bitmap hidden_edges;
+
+    for (unsigned i_edge = 0; i_edge != edge_num; ++i_edge)
+    {
+      Edge* current_edge = _graph->get_edge_by_index(i_edge);
+
+      if (!is_node_visible(current_edge->getSource()->_id) || !is_node_visible(current_edge->getTarget()->_id))
+        hidden_edges.add(i_edge);
+    }
+
+    edges = edges - hidden_edges;
+  }
+
+  edges.to_words(_edge_words, edge_num);
+
+  _combination_dirty = false;
+
+  bool changed = (nodes != _nodes || edges != _edges);
+
+  _nodes = nodes;
+  _edges = edges;
+
+  if (changed)
+    ++_version;
+
+  return changed;
+}
+
+
+unsigned
+FilterEngine::get_version() const
+{
+  return _version;
+}
+
+
+Bitmap const&
+FilterEngine::get_nodes() const
+{
+  return _nodes;
+}
+
+
+Bitmap const&
+FilterEngine::get_edges() const
+{
+  return _edges;
+}
+
+
+bool
+FilterEngine::is_node_visible(unsigned id) const
+{
+  return (_node_words[id / 64] >> (id % 64)) & 1;
+}
+
+
+bool
+FilterEngine::is_edge_visible(unsigned index) const
+{
+  return (_edge_words[index / 64] >> (index % 64)) & 1;
+}
+
+
+std::vector<uint64_t> const&
+FilterEngine::get_node_words() const
+{
+  return _node_words;
+}
+
+
+std::vector<uint64_t> const&
+FilterEngine::get_edge_words() const
+{
+  return _edge_words;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Set minimum and maximum similarity of displayed edges
+  \remarks The window does not change the bitmaps and needs no update(),
+           the edge shaders cull edges outside of it
+*/
+
+void
+FilterEngine::set_minimum_similarity(double sim)
+{
+  _min_similarity = sim;
+}
+
+
+void
+FilterEngine::set_maximum_similarity(double sim)
+{
+  _max_similarity = sim;
+}
+
+
+double
+FilterEngine::get_minimum_similarity() const
+{
+  return _min_similarity;
+}
+
+
+double
+FilterEngine::get_maximum_similarity() const
+{
+  return _max_similarity;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Predicate factories
+  \remarks ...
+*/
+
+/*static*/
+FilterEngine::NodePredicate
+FilterEngine::title_contains(std::string const& text)
+{
+  return [text](Node* node) { return node->_label.find(text) != std::string::npos; };
+}
+
+
+/*static*/
+FilterEngine::NodePredicate
+FilterEngine::degree_range(unsigned min_degree, unsigned max_degree)
+{
+  return [min_degree, max_degree](Node* node)
+  {
+    unsigned degree = node->getDegree();
+    return degree >= min_degree && degree <= max_degree;
+  };
+}
+
+
+/*static*/
+FilterEngine::NodePredicate
+FilterEngine::article_id_range(long min_id, long max_id)
+{
+  return [min_id, max_id](Node* node) { return node->_index >= min_id && node->_index <= max_id; };
+}
+
+
+/*static*/
+FilterEngine::EdgePredicate
+FilterEngine::weight_range(double min_weight, double max_weight)
+{
+  return [min_weight, max_weight](Edge* edge)
+  {
+    double weight = edge->getWeight();
+    return weight >= min_weight && weight <= max_weight;
+  };
+}
+
+
+/*static*/
+Bitmap
+FilterEngine::cluster_size_range(Visualization* graph, unsigned min_size, unsigned max_size)
+{
+  std::vector<uint64_t> words((graph->get_node_num() + 63) / 64, 0);
+
+  for (unsigned i_cluster = 0; i_cluster != graph->get_cluster_num(); ++i_cluster)
+  {
+    Cluster* cluster = graph->get_cluster_by_index(i_cluster);
+
+    unsigned size = cluster->get_node_num();
+
+    if (size < min_size || size > max_size)
+      continue;
+
+    for (unsigned i_node = 0; i_node != size; ++i_node)
+    {
+      unsigned id = cluster->get_node(i_node)->_id;
+      words[id / 64] |= uint64_t(1) << (id % 64);
+    }
+  }
+
+  return Bitmap::from_words(words, graph->get_node_num());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Get predicate by name, appends a new one if there is none
+  \remarks ...
+*/
+
+FilterEngine::Predicate&
+FilterEngine::get_predicate(std::string const& name)
+{
+  for (unsigned i = 0; i != _predicates.size(); ++i)
+    if (_predicates[i].name == name)
+      return _predicates[i];
+
+  Predicate predicate;
+  predicate.name = name;
+  predicate.on_edges = false;
+  predicate.operation = AND;
+  predicate.dirty = true;
+
+  _predicates.push_back(predicate);
+
+  return _predicates.back();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Evaluate a predicate for all nodes or edges
+  \remarks Bitmaps given with set_*_bitmap are kept as they are
+*/
+
+void
+FilterEngine::evaluate(Predicate& predicate)
+{
+  predicate.dirty = false;
+
+  if (predicate.node_predicate)
+  {
+    predicate.bitmap = Bitmap();
+
+    for (int i_node = 0; i_node != _graph->get_node_num(); ++i_node)
+      if (predicate.node_predicate(_graph->get_node_by_index(i_node)))
+        predicate.bitmap.add(i_node);
+  }
+  else if (predicate.edge_predicate)
+  {
+    predicate.bitmap = Bitmap();
+
+    for (int i_edge = 0; i_edge != _graph->get_edge_num(); ++i_edge)
+      if (predicate.edge_predicate(_graph->get_edge_by_index(i_edge)))
+        predicate.bitmap.add(i_edge);
+  }
+}
+
+
+}
@@ -0,0 +1,121 @@
+#ifndef FILTER_ENGINE_HPP
+#define FILTER_ENGINE_HPP
+
+// vta
+#include <cluster/Visualization.hpp>
+#include <filter/Bitmap.hpp>
+
+// cpp
+#include <vector>
+#include <string>
+#include <functional>
+#include <stdint.h>
+
+
+namespace vta
+{
+
+  class Visualization;
+
+
+  class FilterEngine
+  {
+    public:
+      // How a predicate is combined with the predicates before it
+      enum Operation { AND, OR, AND_NOT };
+
+      typedef std::function<bool(Node*)> NodePredicate;
+      typedef std::function<bool(Edge*)> EdgePredicate;
+
+      // Class constructor
+      FilterEngine(Visualization*);
+
+      // Class destructor
+      ~FilterEngine();
+
+      // Add or replace a named predicate, evaluated on the next update()
+      void set_node_predicate(std::string const&, NodePredicate, Operation = AND);
+      void set_edge_predicate(std::string const&, EdgePredicate, Operation = AND);
+
+      // Add or replace a named predicate with an already computed bitmap
+      void set_node_bitmap(std::string const&, Bitmap const&, Operation = AND);
+      void set_edge_bitmap(std::string const&, Bitmap const&, Operation = AND);
+
+      // Remove a predicate
+      void remove_predicate(std::string const&);
+
+      // Recompute the bitmap of a predicate on the next update()
+      void invalidate(std::string const&);
+
+      // Recompute changed predicates and the combination, true if the result changed
+      bool update();
+
+      // Counter that changes whenever update() changed the result
+      unsigned get_version() const;
+
+      // Combined result
+      Bitmap const& get_nodes() const;
+      Bitmap const& get_edges() const;
+
+      // Dense lookup into the combined result (by Node::_id and Edge::getIndex)
+      bool is_node_visible(unsigned) const;
+      bool is_edge_visible(unsigned) const;
+
+      // Combined result as dense words, bit i of word i / 64
+      std::vector<uint64_t> const& get_node_words() const;
+      std::vector<uint64_t> const& get_edge_words() const;
+
+      // Similarity window, applied by the edge shaders at draw time
+      void set_minimum_similarity(double);
+      void set_maximum_similarity(double);
+      double get_minimum_similarity() const;
+      double get_maximum_similarity() const;
+
+      // Predicates over node and edge attributes
+      static NodePredicate title_contains(std::string const&);
+      static NodePredicate degree_range(unsigned, unsigned);
+      static NodePredicate article_id_range(long, long);
+      static EdgePredicate weight_range(double, double);
+
+      // Nodes of all clusters with min <= size <= max
+      static Bitmap cluster_size_range(Visualization*, unsigned, unsigned);
+
+    private:
+      struct Predicate
+      {
+        std::string name;
+        bool on_edges;
+        Operation operation;
+        NodePredicate node_predicate;
+        EdgePredicate edge_predicate;
+        // Cached result of the predicate
+        Bitmap bitmap;
+        bool dirty;
+      };
+
+      // data
+      Visualization* _graph;
+
+      // Predicates in order of combination
+      std::vector<Predicate> _predicates;
+      bool _combination_dirty;
+
+      // Combined result, compressed and dense
+      Bitmap _nodes;
+      Bitmap _edges;
+      std::vector<uint64_t> _node_words;
+      std::vector<uint64_t> _edge_words;
+      unsigned _version;
+
+      // Similarity window
+      double _min_similarity;
+      double _max_similarity;
+
+      Predicate& get_predicate(std::string const&);
+      void evaluate(Predicate&);
+  };
+
+
+} // Namespace vta
+
+#endif // FILTER_ENGINE_HPP
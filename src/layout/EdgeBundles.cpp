@@ -0,0 +1,561 @@
+#include "EdgeBundles.hpp"
+
+// vta
+#include <cluster/Cluster.hpp>
+#include <cluster/SimilarityIndex.hpp>
+#include <util/ThreadPool.hpp>
+
+// cpp
+#include <algorithm>
+#include <iostream>
+#include <stdint.h>
+
+
+namespace vta
+{
+
+namespace
+{
+  const unsigned BUNDLE_BATCH_NODES = 8192;
+
+  // Segment keys: bucket (10 bit) | first point (27 bit) | second point (27 bit)
+  const unsigned POINT_BITS = 27;
+  const uint64_t POINT_MASK = (uint64_t(1) << POINT_BITS) - 1;
+
+
+  struct Cell
+  {
+    int parent;
+    unsigned depth;
+    unsigned count;
+    float x;
+    float y;
+  };
+
+
+  struct PathEntry
+  {
+    uint64_t key;
+    unsigned edge;
+
+    bool operator<(PathEntry const& other) const
+    {
+      return key < other.key;
+    }
+  };
+
+
+  // Bundles of one cluster, points are numbered locally: node i is i, cell j
+  // is node_num + j
+  struct ClusterBundles
+  {
+    std::vector<Cell> cells;
+    std::vector<EdgeBundles::Segment> segments;
+    std::vector<unsigned> segment_bucket;
+    // Edges (Edge::getIndex) of all segments, edge_num per segment in order
+    std::vector<unsigned> segment_edges;
+    unsigned edge_num;
+  };
+
+
+  ////////////////////////////////////////////////////////////////////////////////
+
+  // Quadtree over the points, every cell stores its center of mass. Cells
+  // with one point (or at MAX_DEPTH) are leaves.
+  void build_quadtree(std::vector<float> const& x, std::vector<float> const& y,
+                      std::vector<Cell>& cells, std::vector<unsigned>& leaf)
+  {
+    unsigned point_num = x.size();
+
+    cells.clear();
+    leaf.assign(point_num, 0);
+
+    if (point_num == 0)
+      return;
+
+    float min_x = *std::min_element(x.begin(), x.end());
+    float max_x = *std::max_element(x.begin(), x.end());
+    float min_y = *std::min_element(y.begin(), y.end());
+    float max_y = *std::max_element(y.begin(), y.end());
+
+    std::vector<unsigned> order(point_num);
+
+    for (unsigned i = 0; i != point_num; ++i)
+      order[i] = i;
+
+    struct Range
+    {
+      unsigned cell;
+      unsigned begin;
+      unsigned end;
+      float min_x;
+      float min_y;
+      float size;
+    };
+
+    Cell root = { -1, 0, point_num, 0.0f, 0.0f };
+    cells.push_back(root);
+
+    std::vector<Range> stack;
+    Range root_range = { 0, 0, point_num, min_x, min_y, std::max(max_x - min_x, max_y - min_y) };
+    stack.push_back(root_range);
+
+    while (!stack.empty())
+    {
+      Range range = stack.back();
+      stack.pop_back();
+
+      Cell& cell = cells[range.cell];
+
+      for (unsigned i = range.begin; i != range.end; ++i)
+      {
+        cell.x += x[order[i]];
+        cell.y += y[order[i]];
+      }
+
+      cell.x /= cell.count;
+      cell.y /= cell.count;
+
+      if (cell.count <= 1 || cell.depth == EdgeBundles::MAX_DEPTH)
+      {
+        for (unsigned i = range.begin; i != range.end; ++i)
+          leaf[order[i]] = range.cell;
+
+        continue;
+      }
+
+      float half = range.size * 0.5f;
+      float mid_x = range.min_x + half;
+      float mid_y = range.min_y + half;
+
+      // Split into lower/upper half, then each into left/right
+      std::vector<unsigned>::iterator first = order.begin() + range.begin;
+      std::vector<unsigned>::iterator last = order.begin() + range.end;
+
+      std::vector<unsigned>::iterator upper = std::partition(first, last, [&](unsigned i){ return y[i] < mid_y; });
+      std::vector<unsigned>::iterator lower_right = std::partition(first, upper, [&](unsigned i){ return x[i] < mid_x; });
+      std::vector<unsigned>::iterator upper_right = std::partition(upper, last, [&](unsigned i){ return x[i] < mid_x; });
+
+      unsigned bounds[5] = { range.begin,
+                             (unsigned) (lower_right - order.begin()),
+                             (unsigned) (upper - order.begin()),
+                             (unsigned) (upper_right - order.begin()),
+                             range.end };
+
+      unsigned parent = range.cell;
+      unsigned depth = cell.depth + 1;
+
+      for (unsigned i_child = 0; i_child != 4; ++i_child)
+      {
+        if (bounds[i_child] == bounds[i_child+1])
+          continue;
+
+        Cell child = { (int) parent, depth, bounds[i_child+1] - bounds[i_child], 0.0f, 0.0f };
+
+        Range child_range = { (unsigned) cells.size(), bounds[i_child], bounds[i_child+1],
+                              range.min_x + ((i_child & 1) ? half : 0.0f),
+                              range.min_y + ((i_child & 2) ? half : 0.0f),
+                              half };
+
+        cells.push_back(child);
+        stack.push_back(child_range);
+      }
+    }
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////////////
+
+  // Append a cell of one side of a path, cells with one node or the same
+  // nodes as the cell before give no new control point
+  void append_control_point(std::vector<Cell> const& cells, unsigned cell, std::vector<unsigned>& side)
+  {
+    if (cells[cell].count <= 1)
+      return;
+
+    if (!side.empty() && cells[side.back()].count == cells[cell].count)
+      return;
+
+    side.push_back(cell);
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////////////
+
+  // Route all edges of a cluster through the quadtree and merge the segments
+  void bundle_cluster(Cluster* cluster, FilterEngine const* filter,
+                      std::vector<unsigned> const& local_index, ClusterBundles& result)
+  {
+    unsigned node_num = cluster->get_node_num();
+
+    std::vector<float> x(node_num);
+    std::vector<float> y(node_num);
+
+    for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    {
+      x[i_node] = cluster->get_node(i_node)->_x;
+      y[i_node] = cluster->get_node(i_node)->_y;
+    }
+
+    std::vector<unsigned> leaf;
+    build_quadtree(x, y, result.cells, leaf);
+
+    std::vector<Cell> const& cells = result.cells;
+
+    result.edge_num = 0;
+
+    if (node_num + cells.size() > POINT_MASK)
+    {
+      std::cout << "Cluster with " << node_num << " nodes is too big for edge bundling" << std::endl;
+      return;
+    }
+
+    std::vector<PathEntry> entries;
+
+    std::vector<unsigned> source_side;
+    std::vector<unsigned> target_side;
+    std::vector<unsigned> path;
+
+    for (unsigned i_edge = 0; i_edge != cluster->get_edge_num(); ++i_edge)
+    {
+      Edge* current_edge = cluster->get_edge(i_edge);
+
+      if (filter && !filter->is_edge_visible(current_edge->getIndex()))
+        continue;
+
+      unsigned source = local_index[current_edge->getSource()->_id];
+      unsigned target = local_index[current_edge->getTarget()->_id];
+
+      if (source == target)
+        continue;
+
+      ++result.edge_num;
+
+      // Walk up from both leaves to the lowest common cell
+      source_side.clear();
+      target_side.clear();
+
+      unsigned a = leaf[source];
+      unsigned b = leaf[target];
+
+      while (a != b)
+      {
+        if (cells[a].depth >= cells[b].depth)
+        {
+          a = cells[a].parent;
+          append_control_point(cells, a, source_side);
+        }
+        else
+        {
+          b = cells[b].parent;
+          append_control_point(cells, b, target_side);
+        }
+      }
+
+      // The common cell is the last control point of both sides
+      if (!target_side.empty() && !source_side.empty() && target_side.back() == source_side.back())
+        target_side.pop_back();
+
+      path.clear();
+      path.push_back(source);
+
+      for (unsigned i = 0; i != source_side.size(); ++i)
+        path.push_back(node_num + source_side[i]);
+
+      for (unsigned i = target_side.size(); i != 0; --i)
+      {
+        if (node_num + target_side[i-1] != path.back())
+          path.push_back(node_num + target_side[i-1]);
+      }
+
+      path.push_back(target);
+
+      uint64_t bucket = SimilarityIndex::get_bucket(current_edge->getWeight());
+
+      for (unsigned i = 0; i + 1 != path.size(); ++i)
+      {
+        uint64_t first = std::min(path[i], path[i+1]);
+        uint64_t second = std::max(path[i], path[i+1]);
+
+        PathEntry entry = { (bucket << (2 * POINT_BITS)) | (first << POINT_BITS) | second, i_edge };
+        entries.push_back(entry);
+      }
+    }
+
+    // Equal keys are one segment, sorted by bucket
+    std::sort(entries.begin(), entries.end());
+
+    for (unsigned i_entry = 0; i_entry != entries.size(); )
+    {
+      uint64_t key = entries[i_entry].key;
+
+      EdgeBundles::Segment segment;
+      segment.first = (key >> POINT_BITS) & POINT_MASK;
+      segment.second = key & POINT_MASK;
+      segment.color[0] = segment.color[1] = segment.color[2] = 0.0f;
+      segment.similarity = 0.0f;
+      segment.edge_num = 0;
+
+      for (; i_entry != entries.size() && entries[i_entry].key == key; ++i_entry)
+      {
+        Edge* current_edge = cluster->get_edge(entries[i_entry].edge);
+
+        for (unsigned i = 0; i != 3; ++i)
+          segment.color[i] += current_edge->_color[i];
+
+        segment.similarity = std::max(segment.similarity, (float) current_edge->getWeight());
+
+        result.segment_edges.push_back(current_edge->getIndex());
+        ++segment.edge_num;
+      }
+
+      for (unsigned i = 0; i != 3; ++i)
+        segment.color[i] /= segment.edge_num;
+
+      result.segments.push_back(segment);
+      result.segment_bucket.push_back(key >> (2 * POINT_BITS));
+    }
+  }
+}
+
+
+EdgeBundles::EdgeBundles()
+ : _point_x(),
+   _point_y(),
+   _segments(),
+   _bucket_offsets(SimilarityIndex::BUCKET_NUM + 1, 0),
+   _segment_edge_offsets(1, 0),
+   _segment_edges(),
+   _edge_num(0)
+{}
+
+
+EdgeBundles::~EdgeBundles()
+{}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Bundles all visible edges at the current node positions
+  \remarks Clusters are bundled in batches of about BUNDLE_BATCH_NODES nodes
+           on the thread pool. Call it when a layout is done, not per frame.
+*/
+
+void
+EdgeBundles::build(Visualization* graph, FilterEngine const* filter)
+{
+  unsigned cluster_num = graph->get_cluster_num();
+  unsigned node_num = graph->get_node_num();
+
+  // Index of every node inside its cluster
+  std::vector<unsigned> local_index(node_num, 0);
+
+  for (unsigned i_cluster = 0; i_cluster != cluster_num; ++i_cluster)
+  {
+    Cluster* cluster = graph->get_cluster_by_index(i_cluster);
+
+    for (unsigned i_node = 0; i_node != cluster->get_node_num(); ++i_node)
+      local_index[cluster->get_node(i_node)->_id] = i_node;
+  }
+
+  std::vector<ClusterBundles> cluster_bundles(cluster_num);
+  std::vector<ThreadPool::Task> tasks;
+
+  unsigned batch_begin = 0;
+  unsigned batch_nodes = 0;
+
+  for (unsigned i_cluster = 0; i_cluster != cluster_num; ++i_cluster)
+  {
+    batch_nodes += graph->get_cluster_by_index(i_cluster)->get_node_num();
+
+    if (batch_nodes >= BUNDLE_BATCH_NODES || i_cluster == cluster_num - 1)
+    {
+      unsigned batch_end = i_cluster + 1;
+
+      tasks.push_back([&, batch_begin, batch_end]()
+      {
+        for (unsigned i = batch_begin; i != batch_end; ++i)
+          bundle_cluster(graph->get_cluster_by_index(i), filter, local_index, cluster_bundles[i]);
+      });
+
+      batch_begin = batch_end;
+      batch_nodes = 0;
+    }
+  }
+
+  ThreadPool::get().run(tasks);
+
+  // Nodes first, then the control points of every cluster
+  std::vector<unsigned> cell_offsets(cluster_num + 1, node_num);
+
+  for (unsigned i_cluster = 0; i_cluster != cluster_num; ++i_cluster)
+    cell_offsets[i_cluster+1] = cell_offsets[i_cluster] + cluster_bundles[i_cluster].cells.size();
+
+  _point_x.assign(cell_offsets[cluster_num], 0.0f);
+  _point_y.assign(cell_offsets[cluster_num], 0.0f);
+
+  // Counting sort of all segments by bucket
+  _bucket_offsets.assign(SimilarityIndex::BUCKET_NUM + 1, 0);
+  _edge_num = 0;
+
+  for (unsigned i_cluster = 0; i_cluster != cluster_num; ++i_cluster)
+  {
+    ClusterBundles const& bundles = cluster_bundles[i_cluster];
+
+    for (unsigned i_segment = 0; i_segment != bundles.segments.size(); ++i_segment)
+      ++_bucket_offsets[bundles.segment_bucket[i_segment] + 1];
+
+    _edge_num += bundles.edge_num;
+  }
+
+  for (unsigned i_bucket = 0; i_bucket != SimilarityIndex::BUCKET_NUM; ++i_bucket)
+    _bucket_offsets[i_bucket+1] += _bucket_offsets[i_bucket];
+
+  _segments.resize(_bucket_offsets[SimilarityIndex::BUCKET_NUM]);
+
+  std::vector<unsigned> next(_bucket_offsets.begin(), _bucket_offsets.end() - 1);
+
+  // Sorted index of every segment of every cluster
+  std::vector<std::vector<unsigned> > segment_index(cluster_num);
+
+  for (unsigned i_cluster = 0; i_cluster != cluster_num; ++i_cluster)
+  {
+    Cluster* cluster = graph->get_cluster_by_index(i_cluster);
+    ClusterBundles const& bundles = cluster_bundles[i_cluster];
+
+    unsigned cluster_node_num = cluster->get_node_num();
+
+    for (unsigned i_node = 0; i_node != cluster_node_num; ++i_node)
+    {
+      Node* current_node = cluster->get_node(i_node);
+
+      _point_x[current_node->_id] = current_node->_x;
+      _point_y[current_node->_id] = current_node->_y;
+    }
+
+    for (unsigned i_cell = 0; i_cell != bundles.cells.size(); ++i_cell)
+    {
+      _point_x[cell_offsets[i_cluster] + i_cell] = bundles.cells[i_cell].x;
+      _point_y[cell_offsets[i_cluster] + i_cell] = bundles.cells[i_cell].y;
+    }
+
+    // Local point numbers to global ones
+    for (unsigned i_segment = 0; i_segment != bundles.segments.size(); ++i_segment)
+    {
+      Segment segment = bundles.segments[i_segment];
+
+      segment.first = (segment.first < cluster_node_num) ? cluster->get_node(segment.first)->_id
+                                                        : cell_offsets[i_cluster] + segment.first - cluster_node_num;
+      segment.second = (segment.second < cluster_node_num) ? cluster->get_node(segment.second)->_id
+                                                          : cell_offsets[i_cluster] + segment.second - cluster_node_num;
+
+      segment_index[i_cluster].push_back(next[bundles.segment_bucket[i_segment]]);
+      _segments[next[bundles.segment_bucket[i_segment]]++] = segment;
+    }
+  }
+
+  // Edge lists in segment order
+  _segment_edge_offsets.assign(_segments.size() + 1, 0);
+
+  for (unsigned i_segment = 0; i_segment != _segments.size(); ++i_segment)
+    _segment_edge_offsets[i_segment+1] = _segment_edge_offsets[i_segment] + _segments[i_segment].edge_num;
+
+  _segment_edges.resize(_segment_edge_offsets.back());
+
+  for (unsigned i_cluster = 0; i_cluster != cluster_num; ++i_cluster)
+  {
+    ClusterBundles const& bundles = cluster_bundles[i_cluster];
+
+    unsigned i_edge = 0;
+
+    for (unsigned i_segment = 0; i_segment != bundles.segments.size(); ++i_segment)
+    {
+      unsigned offset = _segment_edge_offsets[segment_index[i_cluster][i_segment]];
+
+      for (unsigned i = 0; i != bundles.segments[i_segment].edge_num; ++i)
+        _segment_edges[offset + i] = bundles.segment_edges[i_edge++];
+    }
+  }
+
+  std::cout << "Bundled " << _edge_num << " edges into " << _segments.size() << " segments" << std::endl;
+}
+
+
+unsigned
+EdgeBundles::get_point_num() const
+{
+  return _point_x.size();
+}
+
+
+float
+EdgeBundles::get_point_x(unsigned index) const
+{
+  return _point_x[index];
+}
+
+
+float
+EdgeBundles::get_point_y(unsigned index) const
+{
+  return _point_y[index];
+}
+
+
+unsigned
+EdgeBundles::get_segment_num() const
+{
+  return _segments.size();
+}
+
+
+EdgeBundles::Segment const&
+EdgeBundles::get_segment(unsigned index) const
+{
+  return _segments[index];
+}
+
+
+unsigned
+EdgeBundles::get_bucket_offset(unsigned bucket) const
+{
+  return _bucket_offsets[bucket];
+}
+
+
+unsigned
+EdgeBundles::get_edge_num() const
+{
+  return _edge_num;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Segments with at least one visible edge
+  \remarks Linear in the bundled path length, no rebuild. A trunk stays
+           visible as long as one of its edges is.
+*/
+
+void
+EdgeBundles::get_visible_segments(FilterEngine const& filter, std::vector<uint64_t>& words) const
+{
+  words.assign((_segments.size() + 63) / 64, 0);
+
+  for (unsigned i_segment = 0; i_segment != _segments.size(); ++i_segment)
+  {
+    for (unsigned i = _segment_edge_offsets[i_segment]; i != _segment_edge_offsets[i_segment+1]; ++i)
+    {
+      if (filter.is_edge_visible(_segment_edges[i]))
+      {
+        words[i_segment / 64] |= uint64_t(1) << (i_segment % 64);
+        break;
+      }
+    }
+  }
+}
+
+
+} // namespace vta
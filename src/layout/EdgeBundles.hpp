@@ -0,0 +1,86 @@
+#ifndef EDGE_BUNDLES_HPP
+#define EDGE_BUNDLES_HPP
+
+// vta
+#include <cluster/Visualization.hpp>
+#include <filter/FilterEngine.hpp>
+
+// cpp
+#include <vector>
+#include <stdint.h>
+
+
+namespace vta
+{
+
+  // Hierarchical edge bundling (Holten) along a quadtree over the node
+  // positions of every cluster. An edge is routed from its source up the
+  // quadtree to the lowest common cell and down to its target, through the
+  // centers of mass of the cells. Edges of the same similarity bucket that
+  // pass between the same two control points share one segment, so a dense
+  // cluster is drawn as a few trunks instead of many crossing lines. Every
+  // segment keeps its edges, so filters can hide segments without a rebuild.
+
+  class EdgeBundles
+  {
+    public:
+      // Line between two points, carrying edge_num edges of one bucket
+      struct Segment
+      {
+        unsigned first;
+        unsigned second;
+        float color[3];
+        // Similarity of the most similar edge
+        float similarity;
+        unsigned edge_num;
+      };
+
+      // Depth limit of the quadtree (nodes at one position)
+      static const unsigned MAX_DEPTH = 16;
+
+      // Class constructor
+      EdgeBundles();
+
+      // Class destructor
+      ~EdgeBundles();
+
+      // Bundle the visible edges at the current node positions, clusters in
+      // parallel (nullptr bundles all edges)
+      void build(Visualization*, FilterEngine const*);
+
+      // Points: the nodes (by Node::_id) followed by the control points
+      unsigned get_point_num() const;
+      float get_point_x(unsigned) const;
+      float get_point_y(unsigned) const;
+
+      // Segments sorted by similarity bucket
+      unsigned get_segment_num() const;
+      Segment const& get_segment(unsigned) const;
+
+      // First segment of a bucket (BUCKET_NUM gives the end of the last bucket)
+      unsigned get_bucket_offset(unsigned) const;
+
+      // Number of edges that were bundled
+      unsigned get_edge_num() const;
+
+      // Bit i is set if segment i carries a visible edge (bit i of word i / 64)
+      void get_visible_segments(FilterEngine const&, std::vector<uint64_t>&) const;
+
+    private:
+      std::vector<float> _point_x;
+      std::vector<float> _point_y;
+
+      std::vector<Segment> _segments;
+      std::vector<unsigned> _bucket_offsets;
+
+      // Edges (Edge::getIndex) of segment i are [_segment_edge_offsets[i], _segment_edge_offsets[i+1])
+      std::vector<unsigned> _segment_edge_offsets;
+      std::vector<unsigned> _segment_edges;
+
+      unsigned _edge_num;
+  };
+
+
+} // Namespace vta
+
+#endif // EDGE_BUNDLES_HPP
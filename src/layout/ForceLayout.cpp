@@ -0,0 +1,460 @@
+#include "ForceLayout.hpp"
+
+// vta
+#include <util/ThreadPool.hpp>
+
+// cpp
+#include <algorithm>
+#include <cmath>
+
+
+namespace vta
+{
+
+namespace
+{
+  // Coincident nodes share a leaf below this depth
+  const unsigned MAX_TREE_DEPTH = 24;
+
+  // Minimum number of nodes per force task
+  const unsigned FORCE_GRAIN = 1024;
+
+  // Golden angle, directions of consecutive nodes never repeat
+  const double GOLDEN_ANGLE = 2.39996322972865332;
+}
+
+
+ForceLayout::ForceLayout(LayoutGraph const& graph)
+ : _graph(graph), _iterations(100), _theta(0.8f), _tree(), _leaves(), _dx(), _dy()
+{}
+
+
+ForceLayout::~ForceLayout()
+{}
+
+
+void
+ForceLayout::set_iterations(unsigned iterations)
+{
+  _iterations = iterations;
+}
+
+
+void
+ForceLayout::set_theta(float theta)
+{
+  _theta = theta;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Runs all iterations with linear cooling
+  \remarks ...
+*/
+
+void
+ForceLayout::run(std::vector<float>& x, std::vector<float>& y, float radius)
+{
+  normalize(x, y);
+  iterate(x, y, get_start_temperature());
+  fit(x, y, radius);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Runs all iterations in layout space
+  \remarks Temperature falls linearly from start_temperature to zero
+*/
+
+void
+ForceLayout::iterate(std::vector<float>& x, std::vector<float>& y, float start_temperature)
+{
+  for (unsigned i_iteration = 0; i_iteration != _iterations; ++i_iteration)
+  {
+    float temperature = start_temperature * (1.0f - (float) i_iteration / _iterations);
+
+    step(x, y, temperature);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Scale positions into a square of side sqrt(n) around (0,0)
+  \remarks With an ideal edge length of 1 this is about the final size
+*/
+
+void
+ForceLayout::normalize(std::vector<float>& x, std::vector<float>& y) const
+{
+  unsigned node_num = x.size();
+
+  if (node_num == 0)
+    return;
+
+  float min_x = *std::min_element(x.begin(), x.end());
+  float max_x = *std::max_element(x.begin(), x.end());
+  float min_y = *std::min_element(y.begin(), y.end());
+  float max_y = *std::max_element(y.begin(), y.end());
+
+  float extent = std::max(max_x - min_x, max_y - min_y);
+
+  // All nodes at one point, start from a circle
+  if (!(extent > 0.0f))
+  {
+    for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    {
+      x[i_node] = cos((M_PI * 2.0 * i_node) / node_num);
+      y[i_node] = sin((M_PI * 2.0 * i_node) / node_num);
+    }
+
+    min_x = min_y = -1.0f;
+    max_x = max_y = 1.0f;
+    extent = 2.0f;
+  }
+
+  float center_x = (min_x + max_x) * 0.5f;
+  float center_y = (min_y + max_y) * 0.5f;
+  float scale = sqrt((float) node_num) / extent;
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+  {
+    x[i_node] = (x[i_node] - center_x) * scale;
+    y[i_node] = (y[i_node] - center_y) * scale;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Center positions at (0,0) and scale them into radius
+  \remarks ...
+*/
+
+void
+ForceLayout::fit(std::vector<float>& x, std::vector<float>& y, float radius) const
+{
+  unsigned node_num = x.size();
+
+  if (node_num == 0)
+    return;
+
+  float min_x = *std::min_element(x.begin(), x.end());
+  float max_x = *std::max_element(x.begin(), x.end());
+  float min_y = *std::min_element(y.begin(), y.end());
+  float max_y = *std::max_element(y.begin(), y.end());
+
+  float center_x = (min_x + max_x) * 0.5f;
+  float center_y = (min_y + max_y) * 0.5f;
+
+  float max_distance = 0.0f;
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+  {
+    x[i_node] -= center_x;
+    y[i_node] -= center_y;
+
+    max_distance = std::max(max_distance, x[i_node] * x[i_node] + y[i_node] * y[i_node]);
+  }
+
+  max_distance = sqrt(max_distance);
+
+  float scale = max_distance > 0.0f ? radius / max_distance : 0.0f;
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+  {
+    x[i_node] *= scale;
+    y[i_node] *= scale;
+  }
+}
+
+
+float
+ForceLayout::get_start_temperature() const
+{
+  return sqrt((float) _graph.get_node_num()) * 0.1f;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   One iteration: build the quadtree, compute all forces in parallel
+           and move every node at most temperature
+  \remarks Forces run on the shared thread pool, so large clusters are split
+           even when they are laid out from inside a pool task
+*/
+
+void
+ForceLayout::step(std::vector<float>& x, std::vector<float>& y, float temperature)
+{
+  unsigned node_num = x.size();
+
+  if (node_num < 2)
+    return;
+
+  build_tree(x, y);
+
+  _dx.assign(node_num, 0.0f);
+  _dy.assign(node_num, 0.0f);
+
+  ThreadPool::get().parallel_for(0, node_num, FORCE_GRAIN, [this, &x, &y](unsigned begin, unsigned end)
+  {
+    compute_forces(begin, end, x, y);
+  });
+
+  // Move nodes, limited by the temperature
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+  {
+    float length = sqrt(_dx[i_node] * _dx[i_node] + _dy[i_node] * _dy[i_node]);
+
+    if (length > temperature)
+    {
+      _dx[i_node] *= temperature / length;
+      _dy[i_node] *= temperature / length;
+    }
+
+    x[i_node] += _dx[i_node];
+    y[i_node] += _dy[i_node];
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Build the quadtree over all nodes
+  \remarks Sums are turned into centers of mass afterwards
+*/
+
+void
+ForceLayout::build_tree(std::vector<float> const& x, std::vector<float> const& y)
+{
+  unsigned node_num = x.size();
+
+  float min_x = *std::min_element(x.begin(), x.end());
+  float max_x = *std::max_element(x.begin(), x.end());
+  float min_y = *std::min_element(y.begin(), y.end());
+  float max_y = *std::max_element(y.begin(), y.end());
+
+  QuadNode root;
+  root.center_x = 0.0f;
+  root.center_y = 0.0f;
+  root.mass = 0.0f;
+  root.min_x = min_x;
+  root.min_y = min_y;
+  root.size = std::max(std::max(max_x - min_x, max_y - min_y), 1e-6f) * 1.0001f;
+  root.child = -1;
+  root.body = -1;
+
+  _tree.clear();
+  _tree.reserve(node_num * 2);
+  _tree.push_back(root);
+
+  _leaves.assign(node_num, 0);
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    insert(i_node, x[i_node], y[i_node]);
+
+  for (unsigned i_cell = 0; i_cell != _tree.size(); ++i_cell)
+  {
+    QuadNode& cell = _tree[i_cell];
+
+    if (cell.mass > 0.0f)
+    {
+      cell.center_x /= cell.mass;
+      cell.center_y /= cell.mass;
+    }
+  }
+}
+
+
+void
+ForceLayout::insert(unsigned body, float x, float y)
+{
+  unsigned cell = 0;
+
+  for (unsigned depth = 0; ; ++depth)
+  {
+    // Empty leaf
+    if (_tree[cell].mass == 0.0f)
+    {
+      _tree[cell].body = body;
+      _tree[cell].center_x = x;
+      _tree[cell].center_y = y;
+      _tree[cell].mass = 1.0f;
+      _leaves[body] = cell;
+      return;
+    }
+
+    // Occupied leaf, split it or merge coincident nodes at the maximum depth
+    if (_tree[cell].child < 0)
+    {
+      if (depth >= MAX_TREE_DEPTH)
+      {
+        _tree[cell].center_x += x;
+        _tree[cell].center_y += y;
+        _tree[cell].mass += 1.0f;
+        _leaves[body] = cell;
+        return;
+      }
+
+      QuadNode parent = _tree[cell];
+      float half = parent.size * 0.5f;
+
+      _tree[cell].child = _tree.size();
+      _tree[cell].body = -1;
+
+      for (unsigned i_child = 0; i_child != 4; ++i_child)
+      {
+        QuadNode child;
+        child.center_x = 0.0f;
+        child.center_y = 0.0f;
+        child.mass = 0.0f;
+        child.min_x = parent.min_x + ((i_child & 1) ? half : 0.0f);
+        child.min_y = parent.min_y + ((i_child & 2) ? half : 0.0f);
+        child.size = half;
+        child.child = -1;
+        child.body = -1;
+
+        _tree.push_back(child);
+      }
+
+      // Move the existing node down
+      unsigned quadrant = (parent.center_x >= parent.min_x + half ? 1 : 0) |
+                          (parent.center_y >= parent.min_y + half ? 2 : 0);
+
+      QuadNode& moved = _tree[_tree[cell].child + quadrant];
+      moved.body = parent.body;
+      moved.center_x = parent.center_x;
+      moved.center_y = parent.center_y;
+      moved.mass = 1.0f;
+
+      _leaves[parent.body] = _tree[cell].child + quadrant;
+    }
+
+    QuadNode& current = _tree[cell];
+
+    current.center_x += x;
+    current.center_y += y;
+    current.mass += 1.0f;
+
+    float half = current.size * 0.5f;
+    unsigned quadrant = (x >= current.min_x + half ? 1 : 0) |
+                        (y >= current.min_y + half ? 2 : 0);
+
+    cell = current.child + quadrant;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Repulsion from the quadtree and attraction along the edges for the
+           nodes in [begin, end)
+  \remarks Only reads shared data, every thread writes its own displacements.
+           The leaf of a node repels it without the node's own mass, so
+           nodes merged into one leaf still push each other apart.
+*/
+
+void
+ForceLayout::compute_forces(unsigned begin, unsigned end, std::vector<float> const& x, std::vector<float> const& y)
+{
+  float theta_squared = _theta * _theta;
+
+  std::vector<unsigned> stack;
+  stack.reserve(4 * MAX_TREE_DEPTH);
+
+  for (unsigned i_node = begin; i_node != end; ++i_node)
+  {
+    float node_x = x[i_node];
+    float node_y = y[i_node];
+
+    float force_x = 0.0f;
+    float force_y = 0.0f;
+
+    // Repulsion k^2/d with k = 1
+    stack.clear();
+    stack.push_back(0);
+
+    while (!stack.empty())
+    {
+      unsigned i_cell = stack.back();
+      stack.pop_back();
+
+      QuadNode const& cell = _tree[i_cell];
+
+      if (cell.mass == 0.0f)
+        continue;
+
+      float dx = node_x - cell.center_x;
+      float dy = node_y - cell.center_y;
+      float distance_squared = dx * dx + dy * dy;
+
+      // The other nodes of the own leaf are merged with it (coincident up to
+      // rounding), they push it in a direction of its own
+      bool coincident = distance_squared < 1e-12f;
+      float mass = cell.mass;
+
+      if (i_cell == _leaves[i_node])
+      {
+        mass -= 1.0f;
+        coincident = true;
+
+        if (mass == 0.0f)
+          continue;
+      }
+
+      // Cells around the node are always opened, at float precision the
+      // center of mass of a tiny cell can be further away than its size
+      bool inside = node_x >= cell.min_x && node_x < cell.min_x + cell.size &&
+                    node_y >= cell.min_y && node_y < cell.min_y + cell.size;
+
+      if (cell.child < 0 || (!inside && cell.size * cell.size < theta_squared * distance_squared))
+      {
+        if (coincident)
+        {
+          double angle = fmod(GOLDEN_ANGLE * i_node, 2.0 * M_PI);
+
+          dx = cos(angle) * 1e-3f;
+          dy = sin(angle) * 1e-3f;
+          distance_squared = 1e-6f;
+        }
+
+        force_x += mass * dx / distance_squared;
+        force_y += mass * dy / distance_squared;
+      }
+      else
+      {
+        for (unsigned i_child = 0; i_child != 4; ++i_child)
+          stack.push_back(cell.child + i_child);
+      }
+    }
+
+    // Attraction w * d^2/k along the edges
+    for (unsigned i_edge = _graph._offsets[i_node]; i_edge != _graph._offsets[i_node+1]; ++i_edge)
+    {
+      unsigned neighbor = _graph._targets[i_edge];
+
+      float dx = x[neighbor] - node_x;
+      float dy = y[neighbor] - node_y;
+      float distance = sqrt(dx * dx + dy * dy);
+
+      force_x += _graph._weights[i_edge] * dx * distance;
+      force_y += _graph._weights[i_edge] * dy * distance;
+    }
+
+    _dx[i_node] = force_x;
+    _dy[i_node] = force_y;
+  }
+}
+
+
+}
@@ -0,0 +1,92 @@
+#ifndef FORCE_LAYOUT_HPP
+#define FORCE_LAYOUT_HPP
+
+// vta
+#include <layout/LayoutGraph.hpp>
+
+// cpp
+#include <vector>
+
+
+namespace vta
+{
+
+  // Force directed layout (Fruchterman-Reingold forces), repulsion is
+  // approximated with a Barnes-Hut quadtree in O(n log n) per iteration and
+  // attraction is weighted by the edge similarity
+
+  class ForceLayout
+  {
+    public:
+      // Class constructor
+      ForceLayout(LayoutGraph const&);
+
+      // Class destructor
+      ~ForceLayout();
+
+      // Number of iterations of run()
+      void set_iterations(unsigned);
+
+      // Barnes-Hut opening angle, 0 computes all pairs exactly
+      void set_theta(float);
+
+      // Layout from the given start positions, the result is centered at
+      // (0,0) and fits into radius
+      void run(std::vector<float>&, std::vector<float>&, float);
+
+      // Run all iterations in layout space, cooling down from temperature
+      void iterate(std::vector<float>&, std::vector<float>&, float);
+
+      // Scale start positions into layout space (ideal edge length 1)
+      void normalize(std::vector<float>&, std::vector<float>&) const;
+
+      // Fit positions from layout space into radius around (0,0)
+      void fit(std::vector<float>&, std::vector<float>&, float) const;
+
+      // One iteration in layout space, nodes move at most temperature
+      void step(std::vector<float>&, std::vector<float>&, float);
+
+      // Start temperature of run()
+      float get_start_temperature() const;
+
+    private:
+      struct QuadNode
+      {
+        // Sum of positions (center of mass after build_tree) and node count
+        float center_x;
+        float center_y;
+        float mass;
+        // Cell
+        float min_x;
+        float min_y;
+        float size;
+        // First of four children, -1 for leaves
+        int child;
+        // Node of a leaf
+        int body;
+      };
+
+      LayoutGraph const& _graph;
+
+      unsigned _iterations;
+      float _theta;
+
+      // Quadtree of the current iteration
+      std::vector<QuadNode> _tree;
+
+      // Leaf of every node, coincident nodes share one
+      std::vector<unsigned> _leaves;
+
+      // Displacement of the current iteration
+      std::vector<float> _dx;
+      std::vector<float> _dy;
+
+      void build_tree(std::vector<float> const&, std::vector<float> const&);
+      void insert(unsigned, float, float);
+      void compute_forces(unsigned, unsigned, std::vector<float> const&, std::vector<float> const&);
+  };
+
+
+} // Namespace vta
+
+#endif // FORCE_LAYOUT_HPP
@@ -0,0 +1,117 @@
+#include "LayoutGraph.hpp"
+
+// vta
+#include <cluster/Cluster.hpp>
+
+// cpp
+#include <unordered_map>
+
+
+namespace vta
+{
+
+
+LayoutGraph::LayoutGraph()
+ : _offsets(1, 0), _targets(), _weights()
+{}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Build the adjacency of a cluster
+  \remarks Edges leaving the cluster are ignored, every edge is stored in
+           both directions
+*/
+
+/*static*/
+LayoutGraph
+LayoutGraph::from_cluster(Cluster* cluster)
+{
+  unsigned node_num = cluster->get_node_num();
+
+  std::unordered_map<Node*, unsigned> local_index;
+  local_index.reserve(node_num);
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    local_index[cluster->get_node(i_node)] = i_node;
+
+  std::vector<unsigned> sources;
+  std::vector<unsigned> targets;
+  std::vector<float> weights;
+
+  for (unsigned i_edge = 0; i_edge != cluster->get_edge_num(); ++i_edge)
+  {
+    Edge* current_edge = cluster->get_edge(i_edge);
+
+    std::unordered_map<Node*, unsigned>::const_iterator source = local_index.find(current_edge->getSource());
+    std::unordered_map<Node*, unsigned>::const_iterator target = local_index.find(current_edge->getTarget());
+
+    if (source == local_index.end() || target == local_index.end() || source->second == target->second)
+      continue;
+
+    sources.push_back(source->second);
+    targets.push_back(target->second);
+    weights.push_back(current_edge->getWeight());
+  }
+
+  return from_edges(node_num, sources, targets, weights);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Build the adjacency from an edge list
+  \remarks Counting sort by node, every edge is stored in both directions
+*/
+
+/*static*/
+LayoutGraph
+LayoutGraph::from_edges(unsigned node_num,
+                        std::vector<unsigned> const& sources,
+                        std::vector<unsigned> const& targets,
+                        std::vector<float> const& weights)
+{
+  LayoutGraph graph;
+
+  graph._offsets.assign(node_num + 1, 0);
+
+  for (unsigned i_edge = 0; i_edge != sources.size(); ++i_edge)
+  {
+    ++graph._offsets[sources[i_edge] + 1];
+    ++graph._offsets[targets[i_edge] + 1];
+  }
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    graph._offsets[i_node + 1] += graph._offsets[i_node];
+
+  graph._targets.assign(graph._offsets[node_num], 0);
+  graph._weights.assign(graph._offsets[node_num], 0.0f);
+
+  std::vector<unsigned> insert_position(graph._offsets.begin(), graph._offsets.end() - 1);
+
+  for (unsigned i_edge = 0; i_edge != sources.size(); ++i_edge)
+  {
+    unsigned source = sources[i_edge];
+    unsigned target = targets[i_edge];
+
+    graph._targets[insert_position[source]] = target;
+    graph._weights[insert_position[source]++] = weights[i_edge];
+
+    graph._targets[insert_position[target]] = source;
+    graph._weights[insert_position[target]++] = weights[i_edge];
+  }
+
+  return graph;
+}
+
+
+unsigned
+LayoutGraph::get_node_num() const
+{
+  return _offsets.size() - 1;
+}
+
+
+}
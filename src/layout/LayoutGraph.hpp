@@ -0,0 +1,43 @@
+#ifndef LAYOUT_GRAPH_HPP
+#define LAYOUT_GRAPH_HPP
+
+// cpp
+#include <vector>
+
+
+namespace vta
+{
+
+  class Cluster;
+
+
+  // Undirected adjacency of a cluster in compressed sparse row form, nodes
+  // are numbered like the nodes of the cluster
+
+  struct LayoutGraph
+  {
+    // Class constructor
+    LayoutGraph();
+
+    // Build from the nodes and edges of a cluster
+    static LayoutGraph from_cluster(Cluster*);
+
+    // Build from an edge list
+    static LayoutGraph from_edges(unsigned,
+                                  std::vector<unsigned> const&,
+                                  std::vector<unsigned> const&,
+                                  std::vector<float> const&);
+
+    // Number of nodes
+    unsigned get_node_num() const;
+
+    // Neighbors of node i are _targets[_offsets[i]] .. _targets[_offsets[i+1]-1]
+    std::vector<unsigned> _offsets;
+    std::vector<unsigned> _targets;
+    std::vector<float> _weights;
+  };
+
+
+} // Namespace vta
+
+#endif // LAYOUT_GRAPH_HPP
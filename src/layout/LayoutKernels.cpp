@@ -0,0 +1,126 @@
+#include "LayoutKernels.hpp"
+
+// cpp
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+
+namespace vta
+{
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Places count points on a circle with radius around (0,0)
+  \remarks Matches cos/sin in double precision up to float rounding
+*/
+
+/*static*/
+void
+LayoutKernels::circle(float* x, float* y, unsigned count, float radius)
+{
+  if (count == 0)
+    return;
+
+  double angle = (M_PI * 2.0) / count;
+
+  // Rotation by LANES steps
+  float rotation_cos = cos(angle * LANES);
+  float rotation_sin = sin(angle * LANES);
+
+  for (unsigned block_begin = 0; block_begin < count; block_begin += ANCHOR_STEP)
+  {
+    unsigned block_end = std::min(count, block_begin + ANCHOR_STEP);
+
+    // Exact anchors for every lane
+    float lane_x[LANES];
+    float lane_y[LANES];
+
+    for (unsigned i_lane = 0; i_lane != LANES; ++i_lane)
+    {
+      lane_x[i_lane] = cos(angle * (block_begin + i_lane)) * radius;
+      lane_y[i_lane] = sin(angle * (block_begin + i_lane)) * radius;
+    }
+
+    unsigned i_node = block_begin;
+
+    for (; i_node + LANES <= block_end; i_node += LANES)
+    {
+      for (unsigned i_lane = 0; i_lane != LANES; ++i_lane)
+      {
+        x[i_node + i_lane] = lane_x[i_lane];
+        y[i_node + i_lane] = lane_y[i_lane];
+      }
+
+      for (unsigned i_lane = 0; i_lane != LANES; ++i_lane)
+      {
+        float next_x = lane_x[i_lane] * rotation_cos - lane_y[i_lane] * rotation_sin;
+        float next_y = lane_x[i_lane] * rotation_sin + lane_y[i_lane] * rotation_cos;
+
+        lane_x[i_lane] = next_x;
+        lane_y[i_lane] = next_y;
+      }
+    }
+
+    for (unsigned i_lane = 0; i_node != block_end; ++i_node, ++i_lane)
+    {
+      x[i_node] = lane_x[i_lane];
+      y[i_node] = lane_y[i_lane];
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Places nodes on concentric rings
+  \remarks Every ring is generated contiguously with circle() and gathered
+           into node order afterwards
+*/
+
+/*static*/
+void
+LayoutKernels::rings(unsigned const* node_ring, unsigned node_num,
+                     float const* ring_radius, unsigned ring_num,
+                     float* x, float* y)
+{
+  // Ring sizes and offsets
+  std::vector<unsigned> ring_offset(ring_num + 1, 0);
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    if (node_ring[i_node] < ring_num)
+      ++ring_offset[node_ring[i_node] + 1];
+
+  for (unsigned i_ring = 0; i_ring != ring_num; ++i_ring)
+    ring_offset[i_ring + 1] += ring_offset[i_ring];
+
+  // All rings one after another
+  std::vector<float> ring_x(ring_offset[ring_num]);
+  std::vector<float> ring_y(ring_offset[ring_num]);
+
+  for (unsigned i_ring = 0; i_ring != ring_num; ++i_ring)
+  {
+    circle(ring_x.data() + ring_offset[i_ring], ring_y.data() + ring_offset[i_ring],
+           ring_offset[i_ring + 1] - ring_offset[i_ring], ring_radius[i_ring]);
+  }
+
+  // Gather in node order
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+  {
+    unsigned i_ring = node_ring[i_node];
+
+    if (i_ring >= ring_num)
+      continue;
+
+    unsigned position = ring_offset[i_ring]++;
+
+    x[i_node] = ring_x[position];
+    y[i_node] = ring_y[position];
+  }
+}
+
+
+}
@@ -0,0 +1,30 @@
+#ifndef LAYOUT_KERNELS_HPP
+#define LAYOUT_KERNELS_HPP
+
+
+namespace vta
+{
+
+  // Placement kernels over float position arrays (structure of arrays).
+  // Positions are relative to the cluster center. Angles are generated by
+  // incremental rotation in blocks of LANES independent lanes (vectorized by
+  // the compiler) and re-anchored with exact sincos every ANCHOR_STEP nodes.
+
+  struct LayoutKernels
+  {
+    static const unsigned LANES = 8;
+    static const unsigned ANCHOR_STEP = 256;
+
+    // count points on a circle, point i at angle 2*pi*i/count
+    static void circle(float*, float*, unsigned, float);
+
+    // Nodes on concentric rings: every node has a ring (ring_num means not
+    // placed) and is put on its ring in node order. Not placed nodes keep
+    // their positions.
+    static void rings(unsigned const*, unsigned, float const*, unsigned, float*, float*);
+  };
+
+
+} // Namespace vta
+
+#endif // LAYOUT_KERNELS_HPP
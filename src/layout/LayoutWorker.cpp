@@ -0,0 +1,417 @@
+#include "LayoutWorker.hpp"
+
+// vta
+#include <cluster/Cluster.hpp>
+#include <layout/LayoutGraph.hpp>
+#include <layout/ForceLayout.hpp>
+#include <layout/PivotMds.hpp>
+#include <util/ThreadPool.hpp>
+
+// cpp
+#include <iostream>
+#include <algorithm>
+
+
+namespace vta
+{
+
+namespace
+{
+  // Clusters of at least this size get the force layout step by step with
+  // intermediate snapshots, smaller ones are batched on the thread pool
+  const unsigned ANYTIME_NODE_NUM = 4096;
+
+  const unsigned LAYOUT_BATCH_NODES = 8192;
+
+  // Same iteration count as ForceLayout::run()
+  const unsigned FORCE_ITERATIONS = 100;
+
+
+  // Layout one cluster on positions in units of the cluster radius
+  void layout_cluster(Cluster* cluster, Visualization::Layout layout, std::vector<float>& x, std::vector<float>& y)
+  {
+    switch (layout)
+    {
+      case Visualization::RADIAL_LAYOUT:     cluster->make_radial_layout(x, y, 1.0f);     break;
+      case Visualization::RING_LAYOUT:       cluster->make_ring_layout(x, y, 1.0f);       break;
+      case Visualization::FORCE_LAYOUT:      cluster->make_force_layout(x, y, 1.0f);      break;
+      case Visualization::MULTILEVEL_LAYOUT: cluster->make_multilevel_layout(x, y, 1.0f); break;
+      case Visualization::PIVOT_MDS_LAYOUT:  cluster->make_pivot_mds_layout(x, y, 1.0f);  break;
+    }
+  }
+
+
+  // Positions of the cluster nodes from positions of all nodes
+  void gather(Cluster* cluster, std::vector<float> const& x, std::vector<float> const& y,
+              std::vector<float>& cluster_x, std::vector<float>& cluster_y)
+  {
+    unsigned node_num = cluster->get_node_num();
+
+    cluster_x.resize(node_num);
+    cluster_y.resize(node_num);
+
+    for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    {
+      unsigned id = cluster->get_node(i_node)->_id;
+
+      cluster_x[i_node] = x[id];
+      cluster_y[i_node] = y[id];
+    }
+  }
+
+
+  void scatter(Cluster* cluster, std::vector<float> const& cluster_x, std::vector<float> const& cluster_y,
+               std::vector<float>& x, std::vector<float>& y)
+  {
+    for (unsigned i_node = 0; i_node != cluster->get_node_num(); ++i_node)
+    {
+      unsigned id = cluster->get_node(i_node)->_id;
+
+      x[id] = cluster_x[i_node];
+      y[id] = cluster_y[i_node];
+    }
+  }
+}
+
+
+LayoutWorker::LayoutWorker(Visualization* graph)
+ : _graph(graph),
+   _pending_job(),
+   _pending(false),
+   _quit(false),
+   _mutex(),
+   _wake_up(),
+   _requested_tag(0),
+   _running(false),
+   _placed_node_num(0),
+   _job_node_num(0),
+   _positions(),
+   _thread()
+{
+  _thread = std::thread(&LayoutWorker::worker_loop, this);
+}
+
+
+LayoutWorker::~LayoutWorker()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _quit = true;
+    ++_requested_tag;
+  }
+
+  _wake_up.notify_one();
+  _thread.join();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Starts a layout of all clusters
+  \remarks Takes the current node positions as start positions, a running
+           layout is cancelled at its next step
+*/
+
+void
+LayoutWorker::start(Visualization::Layout layout)
+{
+  Job job;
+  job.layout = layout;
+  job.x.assign(_graph->get_node_num(), 0.0f);
+  job.y.assign(_graph->get_node_num(), 0.0f);
+
+  for (unsigned i_cluster = 0; i_cluster != _graph->get_cluster_num(); ++i_cluster)
+  {
+    Cluster* cluster = _graph->get_cluster_by_index(i_cluster);
+
+    double radius = cluster->get_radius();
+
+    if (!(radius > 0.0))
+      radius = 1.0;
+
+    for (unsigned i_node = 0; i_node != cluster->get_node_num(); ++i_node)
+    {
+      Node* current_node = cluster->get_node(i_node);
+
+      job.x[current_node->_id] = (current_node->_x - cluster->get_position_x()) / radius;
+      job.y[current_node->_id] = (current_node->_y - cluster->get_position_y()) / radius;
+    }
+
+    job.clusters.push_back(cluster);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    job.tag = ++_requested_tag;
+
+    std::swap(_pending_job, job);
+    _pending = true;
+    _running = true;
+  }
+
+  _wake_up.notify_one();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Moves the nodes to the latest published positions
+  \remarks Snapshots of cancelled layouts are ignored. Cluster positions and
+           radii are read now, so repacking the clusters during a layout is
+           fine.
+*/
+
+bool
+LayoutWorker::apply_latest()
+{
+  if (!_positions.acquire())
+    return false;
+
+  if (_positions.get_tag() != _requested_tag)
+    return false;
+
+  std::vector<float> const& x = _positions.get_x();
+  std::vector<float> const& y = _positions.get_y();
+
+  for (unsigned i_cluster = 0; i_cluster != _graph->get_cluster_num(); ++i_cluster)
+  {
+    Cluster* cluster = _graph->get_cluster_by_index(i_cluster);
+
+    double radius = cluster->get_radius();
+
+    for (unsigned i_node = 0; i_node != cluster->get_node_num(); ++i_node)
+    {
+      Node* current_node = cluster->get_node(i_node);
+
+      current_node->_x = cluster->get_position_x() + x[current_node->_id] * radius;
+      current_node->_y = cluster->get_position_y() + y[current_node->_id] * radius;
+    }
+  }
+
+  _graph->increment_layout_version();
+
+  return true;
+}
+
+
+bool
+LayoutWorker::is_running() const
+{
+  return _running;
+}
+
+
+float
+LayoutWorker::get_progress() const
+{
+  unsigned job_node_num = _job_node_num;
+
+  if (job_node_num == 0)
+    return 1.0f;
+
+  return std::min(1.0f, (float) _placed_node_num / job_node_num);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Waits for jobs and processes them
+*/
+
+void
+LayoutWorker::worker_loop()
+{
+  while (true)
+  {
+    Job job;
+
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+
+      _wake_up.wait(lock, [this]{ return _quit || _pending; });
+
+      if (_quit)
+        return;
+
+      std::swap(job, _pending_job);
+      _pending = false;
+    }
+
+    process(job);
+
+    // Only the latest job reports that it is done
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_pending && job.tag == _requested_tag)
+      _running = false;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Layout all clusters of the job
+  \remarks Big clusters first (clusters are sorted by size): with the force
+           layout they are iterated step by step, everything else runs in
+           batches of about LAYOUT_BATCH_NODES nodes on the thread pool, one
+           round of thread_num batches between two snapshots
+*/
+
+void
+LayoutWorker::process(Job& job)
+{
+  unsigned job_node_num = 0;
+
+  for (unsigned i_cluster = 0; i_cluster != job.clusters.size(); ++i_cluster)
+    job_node_num += job.clusters[i_cluster]->get_node_num();
+
+  _placed_node_num = 0;
+  _job_node_num = job_node_num;
+
+  job.last_publish = std::chrono::steady_clock::now();
+
+  unsigned i_cluster = 0;
+
+  // Big clusters one by one
+  if (job.layout == Visualization::FORCE_LAYOUT)
+  {
+    for (; i_cluster != job.clusters.size() && job.clusters[i_cluster]->get_node_num() >= ANYTIME_NODE_NUM; ++i_cluster)
+    {
+      process_anytime(job, job.clusters[i_cluster]);
+
+      if (is_cancelled(job))
+        return;
+    }
+  }
+
+  // Batches of small clusters
+  std::vector<ThreadPool::Task> tasks;
+
+  unsigned round_size = ThreadPool::get().get_thread_num();
+
+  while (i_cluster != job.clusters.size())
+  {
+    tasks.clear();
+
+    while (tasks.size() != round_size && i_cluster != job.clusters.size())
+    {
+      unsigned batch_begin = i_cluster;
+      unsigned batch_nodes = 0;
+
+      while (batch_nodes < LAYOUT_BATCH_NODES && i_cluster != job.clusters.size())
+        batch_nodes += job.clusters[i_cluster++]->get_node_num();
+
+      unsigned batch_end = i_cluster;
+
+      tasks.push_back([this, &job, batch_begin, batch_end, batch_nodes]()
+      {
+        std::vector<float> cluster_x;
+        std::vector<float> cluster_y;
+
+        for (unsigned i = batch_begin; i != batch_end; ++i)
+        {
+          gather(job.clusters[i], job.x, job.y, cluster_x, cluster_y);
+          layout_cluster(job.clusters[i], job.layout, cluster_x, cluster_y);
+          scatter(job.clusters[i], cluster_x, cluster_y, job.x, job.y);
+        }
+
+        _placed_node_num += batch_nodes;
+      });
+    }
+
+    ThreadPool::get().run(tasks);
+
+    if (is_cancelled(job))
+      return;
+
+    publish(job, false);
+  }
+
+  publish(job, true);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Force layout of one big cluster with snapshots while it cools down
+  \remarks Same start and schedule as Cluster::make_force_layout(), every
+           snapshot is a fitted copy of the current iteration
+*/
+
+void
+LayoutWorker::process_anytime(Job& job, Cluster* cluster)
+{
+  std::vector<float> cluster_x;
+  std::vector<float> cluster_y;
+
+  gather(cluster, job.x, job.y, cluster_x, cluster_y);
+
+  LayoutGraph graph = LayoutGraph::from_cluster(cluster);
+
+  PivotMds(graph).run(cluster_x, cluster_y, 1.0f);
+
+  ForceLayout force_layout(graph);
+  force_layout.normalize(cluster_x, cluster_y);
+
+  float start_temperature = force_layout.get_start_temperature();
+
+  std::vector<float> fitted_x;
+  std::vector<float> fitted_y;
+
+  for (unsigned i_iteration = 0; i_iteration != FORCE_ITERATIONS; ++i_iteration)
+  {
+    float temperature = start_temperature * (1.0f - (float) i_iteration / FORCE_ITERATIONS);
+
+    force_layout.step(cluster_x, cluster_y, temperature);
+
+    if (is_cancelled(job))
+      return;
+
+    if (std::chrono::steady_clock::now() - job.last_publish >= std::chrono::milliseconds(PUBLISH_INTERVAL_MS))
+    {
+      fitted_x = cluster_x;
+      fitted_y = cluster_y;
+
+      force_layout.fit(fitted_x, fitted_y, 1.0f);
+      scatter(cluster, fitted_x, fitted_y, job.x, job.y);
+
+      publish(job, true);
+    }
+  }
+
+  force_layout.fit(cluster_x, cluster_y, 1.0f);
+  scatter(cluster, cluster_x, cluster_y, job.x, job.y);
+
+  _placed_node_num += cluster->get_node_num();
+
+  publish(job, false);
+}
+
+
+void
+LayoutWorker::publish(Job& job, bool always)
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+  if (!always && now - job.last_publish < std::chrono::milliseconds(PUBLISH_INTERVAL_MS))
+    return;
+
+  _positions.publish(job.x, job.y, job.tag);
+  job.last_publish = now;
+}
+
+
+bool
+LayoutWorker::is_cancelled(Job const& job) const
+{
+  return job.tag != _requested_tag;
+}
+
+
+} // namespace vta
@@ -0,0 +1,100 @@
+#ifndef LAYOUT_WORKER_HPP
+#define LAYOUT_WORKER_HPP
+
+// vta
+#include <cluster/Visualization.hpp>
+#include <layout/PositionStore.hpp>
+
+// cpp
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+
+namespace vta
+{
+
+  class Cluster;
+
+  // Computes layouts on a background thread. Positions are kept relative to
+  // the cluster center in units of the cluster radius, intermediate results
+  // are published every PUBLISH_INTERVAL_MS into a PositionStore. The render
+  // thread applies the latest snapshot to the nodes without waiting, so a
+  // layout converges on screen while the UI keeps its frame rate. Starting a
+  // new layout cancels the running one.
+
+  class LayoutWorker
+  {
+    public:
+      static const unsigned PUBLISH_INTERVAL_MS = 50;
+
+      // Class constructor
+      LayoutWorker(Visualization*);
+
+      // Class destructor
+      ~LayoutWorker();
+
+      // Start a layout from the current node positions (render thread)
+      void start(Visualization::Layout);
+
+      // Write the latest published positions to the nodes (render thread),
+      // returns true if nodes were moved
+      bool apply_latest();
+
+      // A layout is being computed
+      bool is_running() const;
+
+      // Share of nodes placed by the running layout in [0,1]
+      float get_progress() const;
+
+    private:
+      struct Job
+      {
+        Visualization::Layout layout;
+        std::vector<Cluster*> clusters;
+        std::vector<float> x;
+        std::vector<float> y;
+        unsigned tag;
+        std::chrono::steady_clock::time_point last_publish;
+      };
+
+      Visualization* _graph;
+
+      // Next job, handed over under _mutex
+      Job _pending_job;
+      bool _pending;
+      bool _quit;
+
+      std::mutex _mutex;
+      std::condition_variable _wake_up;
+
+      // Tag of the latest started job, a running job with another tag is cancelled
+      std::atomic<unsigned> _requested_tag;
+
+      std::atomic<bool> _running;
+      std::atomic<unsigned> _placed_node_num;
+      std::atomic<unsigned> _job_node_num;
+
+      PositionStore _positions;
+
+      std::thread _thread;
+
+      void worker_loop();
+      void process(Job&);
+
+      // Layout a big cluster step by step and publish in between
+      void process_anytime(Job&, Cluster*);
+
+      // Publish the job positions if PUBLISH_INTERVAL_MS passed or always
+      void publish(Job&, bool);
+
+      bool is_cancelled(Job const&) const;
+  };
+
+
+} // Namespace vta
+
+#endif // LAYOUT_WORKER_HPP
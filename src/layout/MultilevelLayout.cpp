@@ -0,0 +1,281 @@
+#include "MultilevelLayout.hpp"
+
+// vta
+#include <layout/ForceLayout.hpp>
+#include <layout/PivotMds.hpp>
+
+// cpp
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+
+namespace vta
+{
+
+namespace
+{
+  // Stop coarsening at this size
+  const unsigned COARSEST_NODE_NUM = 64;
+
+  // Stop coarsening if a level keeps more than this fraction of nodes
+  const float MIN_COARSENING = 0.85f;
+
+  // Iterations for the coarsest graph and the refinement of every level
+  const unsigned COARSEST_ITERATIONS = 300;
+  const unsigned REFINE_ITERATIONS = 30;
+
+  // Refinement starts with this fraction of the start temperature
+  const float REFINE_TEMPERATURE = 0.1f;
+}
+
+
+MultilevelLayout::MultilevelLayout(LayoutGraph const& graph)
+ : _graph(graph), _coarse_graphs(), _coarse_node()
+{}
+
+
+MultilevelLayout::~MultilevelLayout()
+{}
+
+
+unsigned
+MultilevelLayout::get_level_num() const
+{
+  return _coarse_graphs.size() + 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Coarsen, layout the coarsest graph and refine level by level
+  \remarks The start positions are not used, the coarsest graph starts from
+           its pivot MDS layout
+*/
+
+void
+MultilevelLayout::run(std::vector<float>& x, std::vector<float>& y, float radius)
+{
+  coarsen();
+
+  ForceLayout finest_layout(_graph);
+
+  LayoutGraph const& coarsest = _coarse_graphs.empty() ? _graph : _coarse_graphs.back();
+
+  std::vector<float> level_x;
+  std::vector<float> level_y;
+
+  PivotMds(coarsest).run(level_x, level_y, 1.0f);
+
+  ForceLayout coarsest_layout(coarsest);
+  coarsest_layout.set_iterations(COARSEST_ITERATIONS);
+  coarsest_layout.normalize(level_x, level_y);
+  coarsest_layout.iterate(level_x, level_y, coarsest_layout.get_start_temperature());
+
+  // Interpolate and refine down to the input graph
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> jitter(-0.1f, 0.1f);
+
+  for (int i_level = _coarse_graphs.size() - 1; i_level >= 0; --i_level)
+  {
+    LayoutGraph const& fine = (i_level == 0) ? _graph : _coarse_graphs[i_level - 1];
+
+    unsigned fine_num = fine.get_node_num();
+
+    // Layout space grows with sqrt(n)
+    float scale = sqrt((float) fine_num / _coarse_graphs[i_level].get_node_num());
+
+    std::vector<float> fine_x(fine_num);
+    std::vector<float> fine_y(fine_num);
+
+    for (unsigned i_node = 0; i_node != fine_num; ++i_node)
+    {
+      unsigned coarse = _coarse_node[i_level][i_node];
+
+      fine_x[i_node] = level_x[coarse] * scale + jitter(random);
+      fine_y[i_node] = level_y[coarse] * scale + jitter(random);
+    }
+
+    ForceLayout refine_layout(fine);
+    refine_layout.set_iterations(REFINE_ITERATIONS);
+    refine_layout.iterate(fine_x, fine_y, refine_layout.get_start_temperature() * REFINE_TEMPERATURE);
+
+    level_x.swap(fine_x);
+    level_y.swap(fine_y);
+  }
+
+  x.swap(level_x);
+  y.swap(level_y);
+
+  finest_layout.fit(x, y, radius);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Build coarser levels until the graph is small or stops shrinking
+  \remarks ...
+*/
+
+void
+MultilevelLayout::coarsen()
+{
+  _coarse_graphs.clear();
+  _coarse_node.clear();
+
+  LayoutGraph const* current = &_graph;
+
+  while (current->get_node_num() > COARSEST_NODE_NUM)
+  {
+    std::vector<unsigned> coarse_node;
+    unsigned coarse_num = match(*current, coarse_node);
+
+    if (coarse_num > current->get_node_num() * MIN_COARSENING)
+      break;
+
+    _coarse_graphs.push_back(contract(*current, coarse_node, coarse_num));
+    _coarse_node.push_back(coarse_node);
+
+    current = &_coarse_graphs.back();
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Match every node with its unmatched neighbor of highest weight
+  \remarks Nodes are visited in random order, unmatched nodes stay alone
+*/
+
+/*static*/
+unsigned
+MultilevelLayout::match(LayoutGraph const& graph, std::vector<unsigned>& coarse_node)
+{
+  unsigned node_num = graph.get_node_num();
+  const unsigned UNMATCHED = ~0u;
+
+  std::vector<unsigned> order(node_num);
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    order[i_node] = i_node;
+
+  std::mt19937 random(node_num);
+  std::shuffle(order.begin(), order.end(), random);
+
+  coarse_node.assign(node_num, UNMATCHED);
+
+  unsigned coarse_num = 0;
+
+  for (unsigned i = 0; i != node_num; ++i)
+  {
+    unsigned node = order[i];
+
+    if (coarse_node[node] != UNMATCHED)
+      continue;
+
+    unsigned partner = UNMATCHED;
+    float partner_weight = -1.0f;
+
+    for (unsigned i_edge = graph._offsets[node]; i_edge != graph._offsets[node+1]; ++i_edge)
+    {
+      unsigned neighbor = graph._targets[i_edge];
+
+      if (neighbor != node && coarse_node[neighbor] == UNMATCHED && graph._weights[i_edge] > partner_weight)
+      {
+        partner = neighbor;
+        partner_weight = graph._weights[i_edge];
+      }
+    }
+
+    coarse_node[node] = coarse_num;
+
+    if (partner != UNMATCHED)
+      coarse_node[partner] = coarse_num;
+
+    ++coarse_num;
+  }
+
+  return coarse_num;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Merge matched nodes, parallel edges are merged into the strongest
+  \remarks Edge weights stay similarities, so forces keep their scale
+*/
+
+/*static*/
+LayoutGraph
+MultilevelLayout::contract(LayoutGraph const& graph, std::vector<unsigned> const& coarse_node, unsigned coarse_num)
+{
+  unsigned node_num = graph.get_node_num();
+
+  // Members of every coarse node
+  std::vector<unsigned> member_offsets(coarse_num + 1, 0);
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    ++member_offsets[coarse_node[i_node] + 1];
+
+  for (unsigned i_coarse = 0; i_coarse != coarse_num; ++i_coarse)
+    member_offsets[i_coarse + 1] += member_offsets[i_coarse];
+
+  std::vector<unsigned> members(node_num);
+  std::vector<unsigned> insert_position(member_offsets.begin(), member_offsets.end() - 1);
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    members[insert_position[coarse_node[i_node]]++] = i_node;
+
+  // Collect coarse edges, every pair once (source < target)
+  std::vector<unsigned> sources;
+  std::vector<unsigned> targets;
+  std::vector<float> weights;
+
+  const unsigned NO_EDGE = ~0u;
+  std::vector<unsigned> edge_of_neighbor(coarse_num, NO_EDGE);
+
+  for (unsigned i_coarse = 0; i_coarse != coarse_num; ++i_coarse)
+  {
+    unsigned first_edge = sources.size();
+
+    for (unsigned i_member = member_offsets[i_coarse]; i_member != member_offsets[i_coarse+1]; ++i_member)
+    {
+      unsigned node = members[i_member];
+
+      for (unsigned i_edge = graph._offsets[node]; i_edge != graph._offsets[node+1]; ++i_edge)
+      {
+        unsigned neighbor = coarse_node[graph._targets[i_edge]];
+
+        if (neighbor <= i_coarse)
+          continue;
+
+        if (edge_of_neighbor[neighbor] == NO_EDGE)
+        {
+          edge_of_neighbor[neighbor] = sources.size();
+
+          sources.push_back(i_coarse);
+          targets.push_back(neighbor);
+          weights.push_back(graph._weights[i_edge]);
+        }
+        else
+        {
+          float& weight = weights[edge_of_neighbor[neighbor]];
+          weight = std::max(weight, graph._weights[i_edge]);
+        }
+      }
+    }
+
+    // Reset markers
+    for (unsigned i_edge = first_edge; i_edge != sources.size(); ++i_edge)
+      edge_of_neighbor[targets[i_edge]] = NO_EDGE;
+  }
+
+  return LayoutGraph::from_edges(coarse_num, sources, targets, weights);
+}
+
+
+}
@@ -0,0 +1,55 @@
+#ifndef MULTILEVEL_LAYOUT_HPP
+#define MULTILEVEL_LAYOUT_HPP
+
+// vta
+#include <layout/LayoutGraph.hpp>
+
+// cpp
+#include <vector>
+
+
+namespace vta
+{
+
+  // Multilevel force directed layout: the graph is coarsened by heavy edge
+  // matching until it is small, the coarsest graph is laid out completely and
+  // every finer level starts from the interpolated coarse positions and is
+  // only refined with a few cool iterations
+
+  class MultilevelLayout
+  {
+    public:
+      // Class constructor
+      MultilevelLayout(LayoutGraph const&);
+
+      // Class destructor
+      ~MultilevelLayout();
+
+      // Layout, the result is centered at (0,0) and fits into radius
+      void run(std::vector<float>&, std::vector<float>&, float);
+
+      // Number of levels including the input graph
+      unsigned get_level_num() const;
+
+    private:
+      LayoutGraph const& _graph;
+
+      // Coarser graphs, _coarse_graphs[0] is one level above the input
+      std::vector<LayoutGraph> _coarse_graphs;
+
+      // Coarse node of every node, one vector per level
+      std::vector<std::vector<unsigned> > _coarse_node;
+
+      void coarsen();
+
+      // Heavy edge matching, returns the coarse node of every node and the number of coarse nodes
+      static unsigned match(LayoutGraph const&, std::vector<unsigned>&);
+
+      // Merge matched nodes and their edges
+      static LayoutGraph contract(LayoutGraph const&, std::vector<unsigned> const&, unsigned);
+  };
+
+
+} // Namespace vta
+
+#endif // MULTILEVEL_LAYOUT_HPP
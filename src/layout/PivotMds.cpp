@@ -0,0 +1,391 @@
+#include "PivotMds.hpp"
+
+// vta
+#include <layout/ForceLayout.hpp>
+#include <layout/LayoutKernels.hpp>
+#include <util/ThreadPool.hpp>
+
+// cpp
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <mutex>
+#include <cmath>
+
+
+namespace vta
+{
+
+namespace
+{
+  const unsigned ROW_GRAIN = 4096;
+
+  const unsigned POWER_ITERATIONS = 200;
+
+  // Jitter radius relative to the mean edge length
+  const double JITTER = 0.1;
+
+
+  // Double centered squared distances of one node to all pivots
+  void centered_row(unsigned short const* distance, unsigned pivot_num,
+                    std::vector<double> const& column_mean, double total_mean, double* row)
+  {
+    double row_mean = 0.0;
+
+    for (unsigned i_pivot = 0; i_pivot != pivot_num; ++i_pivot)
+    {
+      row[i_pivot] = (double) distance[i_pivot] * distance[i_pivot];
+      row_mean += row[i_pivot];
+    }
+
+    row_mean /= pivot_num;
+
+    for (unsigned i_pivot = 0; i_pivot != pivot_num; ++i_pivot)
+      row[i_pivot] = -0.5 * (row[i_pivot] - row_mean - column_mean[i_pivot] + total_mean);
+  }
+
+
+  // Main eigenvector of the symmetric matrix, orthogonal to the given ones
+  void power_iteration(std::vector<double> const& matrix, unsigned size,
+                       std::vector<std::vector<double> > const& orthogonal_to,
+                       std::mt19937& random, std::vector<double>& vector)
+  {
+    std::uniform_real_distribution<double> start(-1.0, 1.0);
+
+    vector.resize(size);
+
+    for (unsigned i = 0; i != size; ++i)
+      vector[i] = start(random);
+
+    std::vector<double> next(size);
+
+    for (unsigned i_iteration = 0; i_iteration != POWER_ITERATIONS; ++i_iteration)
+    {
+      for (unsigned i = 0; i != size; ++i)
+      {
+        next[i] = 0.0;
+
+        for (unsigned j = 0; j != size; ++j)
+          next[i] += matrix[i * size + j] * vector[j];
+      }
+
+      for (unsigned i_other = 0; i_other != orthogonal_to.size(); ++i_other)
+      {
+        double dot = 0.0;
+
+        for (unsigned i = 0; i != size; ++i)
+          dot += next[i] * orthogonal_to[i_other][i];
+
+        for (unsigned i = 0; i != size; ++i)
+          next[i] -= dot * orthogonal_to[i_other][i];
+      }
+
+      double length = 0.0;
+
+      for (unsigned i = 0; i != size; ++i)
+        length += next[i] * next[i];
+
+      length = sqrt(length);
+
+      if (!(length > 0.0))
+        return;
+
+      double change = 0.0;
+
+      for (unsigned i = 0; i != size; ++i)
+      {
+        next[i] /= length;
+        change += fabs(next[i] - vector[i]);
+      }
+
+      vector.swap(next);
+
+      if (change < 1e-9)
+        return;
+    }
+  }
+}
+
+
+PivotMds::PivotMds(LayoutGraph const& graph)
+ : _graph(graph), _pivot_num(DEFAULT_PIVOT_NUM)
+{}
+
+
+PivotMds::~PivotMds()
+{}
+
+
+void
+PivotMds::set_pivot_num(unsigned pivot_num)
+{
+  _pivot_num = std::max(2u, pivot_num);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Pivot MDS layout
+  \remarks Pivots are picked max-min: the first is the node of highest degree,
+           every next one is the node farthest from all previous pivots.
+           Distances are kept as 16 bit hop counts, n x k of them.
+*/
+
+void
+PivotMds::run(std::vector<float>& x, std::vector<float>& y, float radius)
+{
+  unsigned node_num = _graph.get_node_num();
+
+  x.resize(node_num);
+  y.resize(node_num);
+
+  if (node_num < 3)
+  {
+    LayoutKernels::circle(x.data(), y.data(), node_num, radius);
+    return;
+  }
+
+  unsigned pivot_num = std::min(_pivot_num, node_num);
+
+  // Distance of every node to every pivot, row major
+  std::vector<unsigned short> distance((size_t) node_num * pivot_num);
+
+  std::vector<unsigned> pivot_distance(node_num);
+  std::vector<unsigned> min_distance(node_num, std::numeric_limits<unsigned>::max());
+  std::vector<unsigned> queue(node_num);
+
+  unsigned pivot = 0;
+
+  for (unsigned i_node = 1; i_node != node_num; ++i_node)
+  {
+    if (_graph._offsets[i_node+1] - _graph._offsets[i_node] > _graph._offsets[pivot+1] - _graph._offsets[pivot])
+      pivot = i_node;
+  }
+
+  for (unsigned i_pivot = 0; i_pivot != pivot_num; ++i_pivot)
+  {
+    bfs(pivot, pivot_distance, queue);
+
+    unsigned next_pivot = 0;
+
+    for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    {
+      unsigned current = std::min(pivot_distance[i_node], (unsigned) std::numeric_limits<unsigned short>::max());
+
+      distance[(size_t) i_node * pivot_num + i_pivot] = current;
+
+      min_distance[i_node] = std::min(min_distance[i_node], current);
+
+      if (min_distance[i_node] > min_distance[next_pivot])
+        next_pivot = i_node;
+    }
+
+    pivot = next_pivot;
+  }
+
+  // Column means of the squared distances
+  std::vector<double> column_mean(pivot_num, 0.0);
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+  {
+    unsigned short const* row = &distance[(size_t) i_node * pivot_num];
+
+    for (unsigned i_pivot = 0; i_pivot != pivot_num; ++i_pivot)
+      column_mean[i_pivot] += (double) row[i_pivot] * row[i_pivot];
+  }
+
+  double total_mean = 0.0;
+
+  for (unsigned i_pivot = 0; i_pivot != pivot_num; ++i_pivot)
+  {
+    column_mean[i_pivot] /= node_num;
+    total_mean += column_mean[i_pivot];
+  }
+
+  total_mean /= pivot_num;
+
+  // C^T C, k x k
+  std::vector<double> product(pivot_num * pivot_num, 0.0);
+  std::mutex product_mutex;
+
+  ThreadPool::get().parallel_for(0, node_num, ROW_GRAIN, [&](unsigned begin, unsigned end)
+  {
+    std::vector<double> local(pivot_num * pivot_num, 0.0);
+    std::vector<double> row(pivot_num);
+
+    for (unsigned i_node = begin; i_node != end; ++i_node)
+    {
+      centered_row(&distance[(size_t) i_node * pivot_num], pivot_num, column_mean, total_mean, row.data());
+
+      for (unsigned i = 0; i != pivot_num; ++i)
+        for (unsigned j = i; j != pivot_num; ++j)
+          local[i * pivot_num + j] += row[i] * row[j];
+    }
+
+    std::lock_guard<std::mutex> lock(product_mutex);
+
+    for (unsigned i = 0; i != pivot_num; ++i)
+      for (unsigned j = i; j != pivot_num; ++j)
+        product[i * pivot_num + j] += local[i * pivot_num + j];
+  });
+
+  for (unsigned i = 0; i != pivot_num; ++i)
+    for (unsigned j = 0; j != i; ++j)
+      product[i * pivot_num + j] = product[j * pivot_num + i];
+
+  // Two main eigenvectors
+  std::mt19937 random(42);
+  std::vector<std::vector<double> > eigenvectors;
+  std::vector<double> eigenvector;
+
+  power_iteration(product, pivot_num, eigenvectors, random, eigenvector);
+  eigenvectors.push_back(eigenvector);
+
+  power_iteration(product, pivot_num, eigenvectors, random, eigenvector);
+  eigenvectors.push_back(eigenvector);
+
+  // Project every node
+  ThreadPool::get().parallel_for(0, node_num, ROW_GRAIN, [&](unsigned begin, unsigned end)
+  {
+    std::vector<double> row(pivot_num);
+
+    for (unsigned i_node = begin; i_node != end; ++i_node)
+    {
+      centered_row(&distance[(size_t) i_node * pivot_num], pivot_num, column_mean, total_mean, row.data());
+
+      double node_x = 0.0;
+      double node_y = 0.0;
+
+      for (unsigned i_pivot = 0; i_pivot != pivot_num; ++i_pivot)
+      {
+        node_x += row[i_pivot] * eigenvectors[0][i_pivot];
+        node_y += row[i_pivot] * eigenvectors[1][i_pivot];
+      }
+
+      x[i_node] = node_x;
+      y[i_node] = node_y;
+    }
+  });
+
+  jitter(x, y, random);
+
+  ForceLayout(_graph).fit(x, y, radius);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Moves every node by a small random offset
+  \remarks Nodes with the same distances to all pivots (the leaves of a star)
+           get the same position, the force layouts can not separate nodes
+           that start on one point. Offsets are within JITTER times the mean
+           edge length and deterministic.
+*/
+
+void
+PivotMds::jitter(std::vector<float>& x, std::vector<float>& y, std::mt19937& random) const
+{
+  unsigned node_num = x.size();
+
+  double length_sum = 0.0;
+  unsigned edge_num = 0;
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+  {
+    for (unsigned i_edge = _graph._offsets[i_node]; i_edge != _graph._offsets[i_node+1]; ++i_edge)
+    {
+      unsigned neighbor = _graph._targets[i_edge];
+
+      double dx = x[neighbor] - x[i_node];
+      double dy = y[neighbor] - y[i_node];
+
+      length_sum += sqrt(dx * dx + dy * dy);
+      ++edge_num;
+    }
+  }
+
+  double edge_length = edge_num != 0 ? length_sum / edge_num : 0.0;
+
+  // All nodes on one point, jitter relative to the size of the layout
+  if (!(edge_length > 0.0))
+  {
+    float min_x = *std::min_element(x.begin(), x.end());
+    float max_x = *std::max_element(x.begin(), x.end());
+    float min_y = *std::min_element(y.begin(), y.end());
+    float max_y = *std::max_element(y.begin(), y.end());
+
+    edge_length = std::max(max_x - min_x, max_y - min_y) / sqrt((double) node_num);
+  }
+
+  if (!(edge_length > 0.0))
+    edge_length = 1.0;
+
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+  for (unsigned i_node = 0; i_node != node_num; ++i_node)
+  {
+    // Uniform in a disc
+    double distance = JITTER * edge_length * sqrt(uniform(random));
+    double angle = 2.0 * M_PI * uniform(random);
+
+    x[i_node] += distance * cos(angle);
+    y[i_node] += distance * sin(angle);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Breadth first search from source
+  \remarks queue has to hold node_num entries
+*/
+
+void
+PivotMds::bfs(unsigned source, std::vector<unsigned>& distance, std::vector<unsigned>& queue) const
+{
+  unsigned node_num = _graph.get_node_num();
+  unsigned unreached = std::numeric_limits<unsigned>::max();
+
+  std::fill(distance.begin(), distance.end(), unreached);
+
+  distance[source] = 0;
+  queue[0] = source;
+
+  unsigned queue_begin = 0;
+  unsigned queue_end = 1;
+
+  while (queue_begin != queue_end)
+  {
+    unsigned node = queue[queue_begin++];
+    unsigned next_distance = distance[node] + 1;
+
+    for (unsigned i_edge = _graph._offsets[node]; i_edge != _graph._offsets[node+1]; ++i_edge)
+    {
+      unsigned target = _graph._targets[i_edge];
+
+      if (distance[target] == unreached)
+      {
+        distance[target] = next_distance;
+        queue[queue_end++] = target;
+      }
+    }
+  }
+
+  // Nodes of other components just beyond the farthest reached node
+  if (queue_end != node_num)
+  {
+    unsigned max_distance = distance[queue[queue_end - 1]];
+
+    for (unsigned i_node = 0; i_node != node_num; ++i_node)
+    {
+      if (distance[i_node] == unreached)
+        distance[i_node] = max_distance + 1;
+    }
+  }
+}
+
+
+} // namespace vta
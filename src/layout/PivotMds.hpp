@@ -0,0 +1,57 @@
+#ifndef PIVOT_MDS_HPP
+#define PIVOT_MDS_HPP
+
+// vta
+#include <layout/LayoutGraph.hpp>
+
+// cpp
+#include <vector>
+#include <random>
+
+
+namespace vta
+{
+
+  // Sparse pivot multidimensional scaling (Brandes & Pich): graph distances
+  // from a few max-min pivots by BFS, the double centered n x k distance
+  // matrix C is projected onto the two main eigenvectors of the k x k matrix
+  // C^T C. Linear in nodes and edges, used directly as a fast layout and as
+  // start positions of the force directed layouts.
+  // Distances are hop counts: the similarities inside a cluster are all high,
+  // weighting them would cost a priority queue per pivot for little change.
+  // Nodes with equal distances would share a position, a small jitter keeps
+  // them apart for the force layouts.
+
+  class PivotMds
+  {
+    public:
+      static const unsigned DEFAULT_PIVOT_NUM = 16;
+
+      // Class constructor
+      PivotMds(LayoutGraph const&);
+
+      // Class destructor
+      ~PivotMds();
+
+      // Number of pivots (BFS runs), the cost grows with pivot_num^2 per node
+      void set_pivot_num(unsigned);
+
+      // Layout, the result is centered at (0,0) and fits into radius
+      void run(std::vector<float>&, std::vector<float>&, float);
+
+    private:
+      LayoutGraph const& _graph;
+
+      unsigned _pivot_num;
+
+      // Hop distances from source, unreached nodes get the maximum distance + 1
+      void bfs(unsigned, std::vector<unsigned>&, std::vector<unsigned>&) const;
+
+      // Separate nodes with equal pivot distances
+      void jitter(std::vector<float>&, std::vector<float>&, std::mt19937&) const;
+  };
+
+
+} // Namespace vta
+
+#endif // PIVOT_MDS_HPP
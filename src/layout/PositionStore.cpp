@@ -0,0 +1,93 @@
+#include "PositionStore.hpp"
+
+// cpp
+#include <algorithm>
+
+
+namespace vta
+{
+
+
+PositionStore::PositionStore()
+ : _back(&_buffers[0]),
+   _published(&_buffers[1]),
+   _front(&_buffers[2]),
+   _fresh(false),
+   _mutex()
+{
+  for (unsigned i_buffer = 0; i_buffer != 3; ++i_buffer)
+    _buffers[i_buffer].tag = 0;
+}
+
+
+PositionStore::~PositionStore()
+{}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Publishes a snapshot of positions
+  \remarks The copy happens outside the lock, only the pointer swap is locked.
+           An unread snapshot is replaced, the reader always gets the latest.
+*/
+
+void
+PositionStore::publish(std::vector<float> const& x, std::vector<float> const& y, unsigned tag)
+{
+  _back->x.assign(x.begin(), x.end());
+  _back->y.assign(y.begin(), y.end());
+  _back->tag = tag;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  std::swap(_back, _published);
+  _fresh = true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Makes the latest published snapshot the front buffer
+  \remarks Returns false and keeps the front buffer if nothing new was
+           published since the last call
+*/
+
+bool
+PositionStore::acquire()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if (!_fresh)
+    return false;
+
+  std::swap(_front, _published);
+  _fresh = false;
+
+  return true;
+}
+
+
+std::vector<float> const&
+PositionStore::get_x() const
+{
+  return _front->x;
+}
+
+
+std::vector<float> const&
+PositionStore::get_y() const
+{
+  return _front->y;
+}
+
+
+unsigned
+PositionStore::get_tag() const
+{
+  return _front->tag;
+}
+
+
+} // namespace vta
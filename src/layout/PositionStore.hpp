@@ -0,0 +1,61 @@
+#ifndef POSITION_STORE_HPP
+#define POSITION_STORE_HPP
+
+// cpp
+#include <vector>
+#include <mutex>
+
+
+namespace vta
+{
+
+  // Double buffered node positions between one writer (layout thread) and one
+  // reader (render thread). Writer and reader each own a buffer, a published
+  // snapshot is handed over in a third slot. Both sides only lock to swap
+  // buffers, neither waits for the other to finish copying or drawing.
+
+  class PositionStore
+  {
+    public:
+      // Class constructor
+      PositionStore();
+
+      // Class destructor
+      ~PositionStore();
+
+      // Writer: copy positions into the back buffer and publish them
+      void publish(std::vector<float> const&, std::vector<float> const&, unsigned);
+
+      // Reader: take the latest published snapshot, false if there is none
+      bool acquire();
+
+      // Reader: positions and tag of the acquired snapshot
+      std::vector<float> const& get_x() const;
+      std::vector<float> const& get_y() const;
+      unsigned get_tag() const;
+
+    private:
+      struct Buffer
+      {
+        std::vector<float> x;
+        std::vector<float> y;
+        unsigned tag;
+      };
+
+      Buffer _buffers[3];
+
+      // Buffer owned by the writer, the handover slot and the reader
+      Buffer* _back;
+      Buffer* _published;
+      Buffer* _front;
+
+      // Handover slot holds a snapshot the reader has not seen
+      bool _fresh;
+
+      std::mutex _mutex;
+  };
+
+
+} // Namespace vta
+
+#endif // POSITION_STORE_HPP
@@ -0,0 +1,280 @@
+#include "DensityRenderer.hpp"
+
+// freeimage
+#include <FreeImage.h>
+
+// cpp
+#include <iostream>
+#include <algorithm>
+
+
+namespace vta
+{
+
+DensityRenderer::DensityRenderer()
+ : _width(0),
+   _height(0),
+   _framebuffer(0),
+   _density_texture(0),
+   _gradient_texture(0),
+   _vertex_array(0),
+   _exposure(0.25f),
+   _previous_framebuffer(0),
+   _blend_enabled(GL_FALSE),
+   _blend_src(GL_ONE),
+   _blend_dst(GL_ZERO),
+   _uniformSet(),
+   _resolveShader(nullptr)
+{
+  std::fill(_viewport, _viewport + 4, 0);
+}
+
+
+DensityRenderer::~DensityRenderer()
+{
+  release();
+
+  if (_gradient_texture)
+    glDeleteTextures(1, &_gradient_texture);
+
+  if (_vertex_array)
+    glDeleteVertexArrays(1, &_vertex_array);
+}
+
+
+void
+DensityRenderer::initialize()
+{
+  // create shader program and attach all components
+  _resolveShader = gloost::gl::ShaderProgram::create();
+  _resolveShader->attachShader(GLOOST_SHADERPROGRAM_VERTEX_SHADER,   "../../shaders/density.vs");
+  _resolveShader->attachShader(GLOOST_SHADERPROGRAM_FRAGMENT_SHADER, "../../shaders/density.fs");
+
+  glGenVertexArrays(1, &_vertex_array);
+
+  _uniformSet.set_int("Density", 0);
+  _uniformSet.set_int("Gradient", 1);
+}
+
+
+void
+DensityRenderer::reload_shaders()
+{
+  if (_resolveShader)
+    _resolveShader->reloadShaders();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Loads a gradient image as lookup texture
+  \remarks The gradients in res/gradients are a few rows of the same colors,
+           the middle row is used. Keeps the previous gradient on failure.
+*/
+
+bool
+DensityRenderer::load_gradient(std::string const& path)
+{
+  FREE_IMAGE_FORMAT format = FreeImage_GetFileType(path.c_str(), 0);
+
+  if (format == FIF_UNKNOWN)
+    format = FreeImage_GetFIFFromFilename(path.c_str());
+
+  FIBITMAP* bitmap = (format != FIF_UNKNOWN) ? FreeImage_Load(format, path.c_str(), 0) : nullptr;
+
+  if (!bitmap)
+  {
+    std::cerr << "Could not load gradient: " << path << std::endl;
+    return false;
+  }
+
+  FIBITMAP* rgba = FreeImage_ConvertTo32Bits(bitmap);
+  FreeImage_Unload(bitmap);
+
+  if (!rgba)
+  {
+    std::cerr << "Could not convert gradient: " << path << std::endl;
+    return false;
+  }
+
+  unsigned width = FreeImage_GetWidth(rgba);
+  BYTE* row = FreeImage_GetScanLine(rgba, FreeImage_GetHeight(rgba) / 2);
+
+  if (!_gradient_texture)
+    glGenTextures(1, &_gradient_texture);
+
+  glBindTexture(GL_TEXTURE_2D, _gradient_texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  // FreeImage stores 32 bit pixels as BGRA (little endian)
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, 1, 0, GL_BGRA, GL_UNSIGNED_BYTE, row);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  FreeImage_Unload(rgba);
+
+  return true;
+}
+
+
+void
+DensityRenderer::set_exposure(float exposure)
+{
+  _exposure = exposure;
+}
+
+
+float
+DensityRenderer::get_exposure() const
+{
+  return _exposure;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Starts accumulating into the density framebuffer
+  \remarks The framebuffer follows the size of the current viewport, the
+           projection stays the same, only the viewport shrinks.
+*/
+
+void
+DensityRenderer::begin()
+{
+  glGetIntegerv(GL_VIEWPORT, _viewport);
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_previous_framebuffer);
+
+  _blend_enabled = glIsEnabled(GL_BLEND);
+  glGetIntegerv(GL_BLEND_SRC_RGB, &_blend_src);
+  glGetIntegerv(GL_BLEND_DST_RGB, &_blend_dst);
+
+  int width  = std::max(1, _viewport[2] / DOWNSAMPLE);
+  int height = std::max(1, _viewport[3] / DOWNSAMPLE);
+
+  if (width != _width || height != _height || !_framebuffer)
+    allocate(width, height);
+
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _framebuffer);
+  glViewport(0, 0, _width, _height);
+
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_ONE, GL_ONE);
+}
+
+
+void
+DensityRenderer::end()
+{
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _previous_framebuffer);
+  glViewport(_viewport[0], _viewport[1], _viewport[2], _viewport[3]);
+
+  glBlendFunc(_blend_src, _blend_dst);
+
+  if (!_blend_enabled)
+    glDisable(GL_BLEND);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Draws the density with the gradient over the viewport
+  \remarks Empty pixels are discarded, the gradient alpha is blended (see
+           rainbow_alpha.png). Without a gradient nothing is drawn.
+*/
+
+void
+DensityRenderer::resolve()
+{
+  if (!_framebuffer || !_gradient_texture)
+    return;
+
+  GLboolean blend_enabled = glIsEnabled(GL_BLEND);
+  GLint blend_src;
+  GLint blend_dst;
+  glGetIntegerv(GL_BLEND_SRC_RGB, &blend_src);
+  glGetIntegerv(GL_BLEND_DST_RGB, &blend_dst);
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  _resolveShader->use();
+  {
+    _uniformSet.set_float("Exposure", _exposure);
+    _uniformSet.applyToShader(_resolveShader.get());
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _density_texture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, _gradient_texture);
+
+    // Full screen triangle from gl_VertexID
+    glBindVertexArray(_vertex_array);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+  _resolveShader->disable();
+
+  glBlendFunc(blend_src, blend_dst);
+
+  if (!blend_enabled)
+    glDisable(GL_BLEND);
+}
+
+
+void
+DensityRenderer::allocate(int width, int height)
+{
+  release();
+
+  _width = width;
+  _height = height;
+
+  glGenTextures(1, &_density_texture);
+  glBindTexture(GL_TEXTURE_2D, _density_texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, _width, _height, 0, GL_RED, GL_FLOAT, nullptr);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glGenFramebuffers(1, &_framebuffer);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _framebuffer);
+  glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _density_texture, 0);
+
+  if (glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    std::cerr << "Density framebuffer is incomplete" << std::endl;
+
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+}
+
+
+void
+DensityRenderer::release()
+{
+  if (_framebuffer)
+    glDeleteFramebuffers(1, &_framebuffer);
+
+  if (_density_texture)
+    glDeleteTextures(1, &_density_texture);
+
+  _framebuffer = 0;
+  _density_texture = 0;
+  _width = 0;
+  _height = 0;
+}
+
+
+} // namespace vta
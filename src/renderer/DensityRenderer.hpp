@@ -0,0 +1,93 @@
+#ifndef DENSITY_RENDERER_HPP
+#define DENSITY_RENDERER_HPP
+
+// gloost
+#include <gloost/gl/ShaderProgram.h>
+#include <gloost/gl/UniformSet.h>
+
+// cpp
+#include <memory>
+#include <string>
+
+// gl
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+
+namespace vta
+{
+
+  // Edge density mode. Edges drawn between begin() and end() are added up in
+  // a float framebuffer at a fraction of the viewport resolution (edge shaders
+  // write their weight), resolve() maps the density with 1 - exp(-d * exposure)
+  // to a gradient texture (res/gradients) and draws it over the viewport.
+  // The resolve costs one pass over the reduced framebuffer, independent of
+  // the number of edges.
+
+  class DensityRenderer
+  {
+    public:
+      // Class constructor
+      DensityRenderer();
+
+      // Class destructor
+      ~DensityRenderer();
+
+      // Create the resolve shader, needs a gl context
+      void initialize();
+
+      // Reload the resolve shader from its files
+      void reload_shaders();
+
+      // Load the gradient lookup (the middle row of the image)
+      bool load_gradient(std::string const&);
+
+      // Density scale of the tone mapping
+      void set_exposure(float);
+      float get_exposure() const;
+
+      // Redirect drawing into the density framebuffer with additive blending
+      void begin();
+
+      // Restore the framebuffer, viewport and blending of begin()
+      void end();
+
+      // Draw the tone mapped density over the viewport
+      void resolve();
+
+    private:
+      // Viewport pixels per density pixel along each axis
+      static const int DOWNSAMPLE = 2;
+
+      // Size of the density framebuffer
+      int _width;
+      int _height;
+
+      GLuint _framebuffer;
+      GLuint _density_texture;
+      GLuint _gradient_texture;
+
+      // Empty vertex array for the full screen triangle
+      GLuint _vertex_array;
+
+      float _exposure;
+
+      // State saved by begin()
+      GLint _viewport[4];
+      GLint _previous_framebuffer;
+      GLboolean _blend_enabled;
+      GLint _blend_src;
+      GLint _blend_dst;
+
+      gloost::gl::UniformSet _uniformSet;
+      std::shared_ptr<gloost::gl::ShaderProgram> _resolveShader;
+
+      // (Re)allocate the framebuffer for a size
+      void allocate(int, int);
+      void release();
+  };
+
+
+} // Namespace vta
+
+#endif // DENSITY_RENDERER_HPP
@@ -25,6 +25,16 @@
 namespace vta
 {
 
+namespace
+{
+  // Half edge length of the node quads in clip space
+  const float NODE_SIZE = 0.002f;
+
+  // Font size of the labels in pixels
+  const float LABEL_SIZE = 24.0f;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -42,16 +52,24 @@ DetailRenderer::DetailRenderer(Visualization* graph):
   _modelMatrixStack(),
 
   _graph(graph),
+  _filter(nullptr),
 
   _uniformSet(),
   _edgeShader(nullptr),
   _nodeShader(nullptr),
-  _typeWriter(nullptr),
-  _vboNodes(nullptr),
-  _vboEdges(nullptr)
+  _vboNodes(),
+  _vboEdges(nullptr),
+  _edge_num(0),
+
+  _label_placer(),
+  _text(),
+
+  _filled_cluster(nullptr),
+  _filled_layout_version(0),
+  _filled_filter_version(0)
 {
-  // create TypeWriter
-  _typeWriter = gloost::FreeTypeWriter::create("../../res/fonts/Verdana.ttf", 12.0f, true);
+  // Estimated from the font size until the text renderer is initialized
+  _label_placer.set_glyph_size(LABEL_SIZE * 0.55f, LABEL_SIZE);
 
   // Set Model View Projection Matrices
   _projectionMatrix.setIdentity();
@@ -104,9 +122,14 @@ DetailRenderer::initialize()
   // create shader program and attach all components for nodes
   _nodeShader = gloost::gl::ShaderProgram::create();
   _nodeShader->attachShader(GLOOST_SHADERPROGRAM_VERTEX_SHADER,   "../../shaders/node.vs");
-  _nodeShader->attachShader(GLOOST_SHADERPROGRAM_GEOMETRY_SHADER, "../../shaders/node.gs");
   _nodeShader->attachShader(GLOOST_SHADERPROGRAM_FRAGMENT_SHADER, "../../shaders/node.fs");
 
+  // Glyph atlas of the labels, label boxes are measured with it
+  if (_text.initialize("../../res/fonts/Verdana.ttf", LABEL_SIZE))
+    _label_placer.set_text_renderer(&_text);
+
+  _text.set_color(0.0f, 1.0f, 0.0f, 1.0f);
+
   std::cout << "Initialized Cluster Visualization" << std::endl;
 
   return true;
@@ -128,15 +151,8 @@ DetailRenderer::fill_vbo_nodes()
   // init nodes
   int numNodes = cluster->get_node_num();
 
- auto interleavedAttributes = gloost::InterleavedAttributes::create();
-
   unsigned containerSize = numNodes * 5; // vec2(position) + vec3(color)
-  std::vector<float>& container = interleavedAttributes->getVector();
-  container = std::vector<float>(containerSize, 0.0f);
-
-  // tell the vertex attribute container which attributes are contained
-  interleavedAttributes->addAttribute(2, 8, "in_position");
-  interleavedAttributes->addAttribute(3, 12, "in_color");
+  std::vector<float> container(containerSize, 0.0f);
 
   unsigned vboIdx = 0;
 
@@ -144,6 +160,9 @@ DetailRenderer::fill_vbo_nodes()
   {
     Node* current_node = cluster->get_node(i);
 
+    if (_filter && !_filter->is_node_visible(current_node->_id))
+      continue;
+
     container[vboIdx++] = current_node->_x; // node x
     container[vboIdx++] = current_node->_y; // node y
 
@@ -151,7 +170,14 @@ DetailRenderer::fill_vbo_nodes()
     container[vboIdx++] = current_node->_color[1]; // node color g
     container[vboIdx++] = current_node->_color[2]; // node color b
   }
-  _vboNodes = gloost::gl::Vbo4::create(interleavedAttributes);
+
+  // Filtered nodes are not written, drop the unused rest
+  container.resize(vboIdx);
+
+  // in_position, in_color
+  _vboNodes.set_format(std::vector<unsigned>{2, 3});
+  _vboNodes.resize(vboIdx / 5);
+  _vboNodes.write(0, container);
 }
 
 
@@ -159,7 +185,8 @@ DetailRenderer::fill_vbo_nodes()
 
 /**
   \brief   Fills the edges-vbo with all edges of the cluster
-  \remarks ...
+  \remarks The similarity window is not applied here but in the edge shader,
+           so moving it needs no refill
 */
 
 void
@@ -171,20 +198,24 @@ DetailRenderer::fill_vbo_edges()
 
   auto interleavedAttributes = gloost::InterleavedAttributes::create();
 
-  unsigned containerSize = numEdges * 10; // vec2 * 2 + vec3 * 2
+  unsigned containerSize = numEdges * 12; // (vec2 + vec3 + float) * 2
   std::vector<float>& container = interleavedAttributes->getVector();
   container = std::vector<float>(containerSize, 0.0f);
 
   // tell the vertex attribute container which attributes are contained
   interleavedAttributes->addAttribute(2, 8, "in_position");
   interleavedAttributes->addAttribute(3, 12, "in_color");
+  interleavedAttributes->addAttribute(1, 4, "in_similarity");
 
   unsigned vboIdx = 0;
 
-  for (unsigned i = 0; i != numEdges; ++i)
+  for (int i = 0; i != numEdges; ++i)
   {
     Edge* current_edge = cluster->get_edge(i);
 
+    if (_filter && !_filter->is_edge_visible(current_edge->getIndex()))
+      continue;
+
     Node* source = current_edge->getSource();
     Node* target = current_edge->getTarget();
 
@@ -195,14 +226,23 @@ DetailRenderer::fill_vbo_edges()
     container[vboIdx++] = current_edge->_color[1]; // edge color g
     container[vboIdx++] = current_edge->_color[2]; // edge color b
 
+    container[vboIdx++] = current_edge->getWeight(); // similarity
+
     container[vboIdx++] = target->_x; // target x
     container[vboIdx++] = target->_y; // target y
 
     container[vboIdx++] = current_edge->_color[0]; // edge color r
     container[vboIdx++] = current_edge->_color[1]; // edge color g
     container[vboIdx++] = current_edge->_color[2]; // edge color b
+
+    container[vboIdx++] = current_edge->getWeight(); // similarity
   }
+
+  // Filtered edges are not written, drop the unused rest
+  container.resize(vboIdx);
+
   _vboEdges = gloost::gl::Vbo4::create(interleavedAttributes);
+  _edge_num = vboIdx / 12;
 }
 
 
@@ -216,11 +256,22 @@ DetailRenderer::fill_vbo_edges()
 void
 DetailRenderer::display()
 {
-  fill_vbo_nodes();
-  fill_vbo_edges();
-
   Cluster* cluster = _graph->get_cluster_by_index(_graph->_detail_view_cluster_index);
 
+  unsigned filter_version = _filter ? _filter->get_version() : 0;
+
+  // Refill only if the cluster, its positions or the filter result changed
+  if (cluster != _filled_cluster || _graph->get_layout_version() != _filled_layout_version ||
+      filter_version != _filled_filter_version)
+  {
+    fill_vbo_nodes();
+    fill_vbo_edges();
+
+    _filled_cluster = cluster;
+    _filled_layout_version = _graph->get_layout_version();
+    _filled_filter_version = filter_version;
+  }
+
   // setup clear color and clear screen
   glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -255,6 +306,10 @@ DetailRenderer::display()
       // Set Edge Color
       _uniformSet.set_vec4("Color", gloost::vec4(0.3, 0.3f, 0.3f, 1.0f));
 
+      // Similarity window, edges outside are culled in the shader
+      _uniformSet.set_float("MinSimilarity", _filter ? _filter->get_minimum_similarity() : 0.0f);
+      _uniformSet.set_float("MaxSimilarity", _filter ? _filter->get_maximum_similarity() : 1.0f);
+
       _uniformSet.applyToShader(_edgeShader.get());
 
       _vboEdges->bind();
@@ -269,11 +324,16 @@ DetailRenderer::display()
       // Set Node Color
       _uniformSet.set_vec4("Color", gloost::vec4(1.0, 0.0f, 0.0f, 1.0f));
 
+      _uniformSet.set_float("NodeSize", NODE_SIZE);
+
       _uniformSet.applyToShader(_nodeShader.get());
 
-      _vboNodes->bind();
-      _vboNodes->draw(GL_POINTS);
-      _vboNodes->unbind();
+      // One quad instance per node
+      _vboNodes.commit();
+      _vboNodes.bind_instanced();
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, _vboNodes.get_vertex_num());
+      _vboNodes.unbind();
+      _vboNodes.fence();
     }
     _nodeShader->disable();
   }
@@ -281,64 +341,35 @@ DetailRenderer::display()
 
 
   // LABEL NODES
-  for (unsigned i = 0; i != cluster->get_node_num(); ++i)
-  {
-    Node* current_node = cluster->get_node(i);
+  float scale = _height/(cluster->get_radius() * 2);
 
-    gloost::Vector3 text_position(current_node->_x, current_node->_y, 0.0);
+  // screen = (world - cluster position) * scale + middle of the screen
+  float offset_x = _width/2 - cluster->get_position_x() * scale;
+  float offset_y = _height/2 - cluster->get_position_y() * scale;
 
-    // Scale Cluster to window size
-    gloost::Matrix model_matrix;
-    float scale = _height/(cluster->get_radius() * 2);
+  std::vector<LabelPlacer::Label> const& labels = _label_placer.place(cluster, _filter, scale, offset_x, offset_y, _width, _height);
 
-    model_matrix.setScale(gloost::Vector3(scale, scale,0.0));
+  // draw text, all labels in one draw call
+  _text.clear();
 
-    text_position = model_matrix * text_position;
+  for (unsigned i = 0; i != labels.size(); ++i)
+    _text.add_text(labels[i].x, labels[i].y, cluster->get_node(labels[i].node)->_label);
 
-    // Translate from original cluster position to 0,0
-    text_position[0] -= cluster->get_position_x() * scale;
-    text_position[1] -= cluster->get_position_y() * scale;
+  _text.draw(_projectionMatrix, _viewMatrix);
+}
 
-    // translate to the middle of the screen
-    text_position[0] += _width/2;
-    text_position[1] += _height/2;
 
-    std::string label = current_node->_label;
+unsigned
+DetailRenderer::get_drawn_node_num() const
+{
+  return _vboNodes.get_vertex_num();
+}
 
-    // draw text
-    glPushMatrix();
-    glPushAttrib(GL_ALL_ATTRIB_BITS);
-    {
-      glDisable(GL_DEPTH_TEST);
-      glDepthMask(GL_FALSE);
-      glEnable(GL_TEXTURE_2D);
-
-      glMatrixMode(GL_PROJECTION);
-      gloostLoadMatrix(_projectionMatrix.data());
-
-      glMatrixMode(GL_MODELVIEW);
-      gloostLoadMatrix(_viewMatrix.data());
-
-      /// _typewriter functions
-      /*
-      // cuts a line, so it is not longer as maxPixelLength with the current font
-      std::string cutLineToLength(const std::string& text, unsigned maxPixelLength) const;
-
-      // sets the scaling
-      void setScale(float scale);
-      */
-
-      _typeWriter->beginText();
-      _typeWriter->setScale(2.0);
-      {
-        glColor4f(0.0f, 1.0f, 0.0f, 1.0f);
-        _typeWriter->writeLine(text_position[0], text_position[1], label);
-      }
-      _typeWriter->endText();
-    }
-    glPopAttrib();
-    glPopMatrix();
-  }
+
+unsigned
+DetailRenderer::get_drawn_edge_num() const
+{
+  return _edge_num;
 }
 
 
@@ -365,6 +396,22 @@ DetailRenderer::resize(int width, int height)
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Use the filters of another view
+  \remarks The filter has to be updated by its owner
+*/
+
+void
+DetailRenderer::set_filter(FilterEngine* filter)
+{
+  _filter = filter;
+
+  _filled_cluster = nullptr;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 } // namespace vta
 
@@ -8,7 +8,6 @@
 #include <gloost/gl/Vbo4.h>
 
 #include <gloost/TextureManager.h>
-#include <gloost/FreeTypeWriter.h>
 #include <gloost/Matrix.h>
 #include <gloost/MatrixStack.h>
 
@@ -26,6 +25,13 @@
 #include <cluster/Edge.hpp>
 // Cluster
 #include <cluster/Cluster.hpp>
+// Filter
+#include <filter/FilterEngine.hpp>
+// Labels
+#include <renderer/LabelPlacer.hpp>
+#include <renderer/TextRenderer.hpp>
+// Buffers
+#include <renderer/VertexBuffer.hpp>
 
 
 namespace vta
@@ -52,9 +58,16 @@ namespace vta
       // display
       void display();
 
+      // Nodes and edges drawn by display()
+      unsigned get_drawn_node_num() const;
+      unsigned get_drawn_edge_num() const;
+
       // resize
       void resize(int width, int height);
 
+      // Use the filters of another view (nullptr shows everything)
+      void set_filter(FilterEngine*);
+
 
     protected:
 
@@ -70,14 +83,25 @@ namespace vta
       // data
       Visualization* _graph;
 
+      // Filters, owned by the overview
+      FilterEngine* _filter;
+
       // gl ressources
       gloost::gl::UniformSet _uniformSet;
       std::shared_ptr<gloost::gl::ShaderProgram> _edgeShader;
       std::shared_ptr<gloost::gl::ShaderProgram> _nodeShader;
-      std::shared_ptr<gloost::gl::Vbo4> _vboNodes;
+      VertexBuffer _vboNodes;
       std::shared_ptr<gloost::gl::Vbo4> _vboEdges;
+      unsigned _edge_num;
+
+      // Labels that fit on screen, cached between frames
+      LabelPlacer _label_placer;
+      TextRenderer _text;
 
-      std::shared_ptr<gloost::FreeTypeWriter> _typeWriter;
+      // State the vbos were filled with, they are only refilled if it changed
+      Cluster* _filled_cluster;
+      unsigned _filled_layout_version;
+      unsigned _filled_filter_version;
 
 
   };
@@ -0,0 +1,218 @@
+#include "DrawCommandBuffer.hpp"
+
+
+namespace vta
+{
+
+DrawCommandBuffer::DrawCommandBuffer()
+ : _commands(),
+   _command_size(ARRAYS_COMMAND_SIZE),
+   _buffer(0),
+   _uploaded(false),
+   _first_index_location(-1)
+{}
+
+
+DrawCommandBuffer::~DrawCommandBuffer()
+{
+  if (_buffer)
+    glDeleteBuffers(1, &_buffer);
+}
+
+
+void
+DrawCommandBuffer::clear()
+{
+  _commands.clear();
+  _uploaded = false;
+}
+
+
+void
+DrawCommandBuffer::add_arrays(unsigned count, unsigned instance_count, unsigned first, unsigned base_instance)
+{
+  _command_size = ARRAYS_COMMAND_SIZE;
+
+  _commands.push_back(count);
+  _commands.push_back(instance_count);
+  _commands.push_back(first);
+  _commands.push_back(base_instance);
+
+  _uploaded = false;
+}
+
+
+void
+DrawCommandBuffer::add_elements(unsigned count, unsigned first_index)
+{
+  GLuint base_instance = get_command_num();
+
+  _command_size = ELEMENTS_COMMAND_SIZE;
+
+  _commands.push_back(count);
+  _commands.push_back(1);
+  _commands.push_back(first_index);
+  _commands.push_back(0); // base vertex
+  _commands.push_back(base_instance);
+
+  _uploaded = false;
+}
+
+
+unsigned
+DrawCommandBuffer::get_command_num() const
+{
+  return _commands.size() / _command_size;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Draws all array commands
+  \remarks Without ARB_multi_draw_indirect the commands are read on the cpu,
+           but uploaded anyway for bind_first_index(). Without
+           ARB_base_instance the instance attributes of the vertex buffer are
+           moved to the base instance of every command.
+*/
+
+void
+DrawCommandBuffer::draw_arrays(GLenum mode, VertexBuffer const& instances)
+{
+  if (_commands.empty())
+    return;
+
+  if (!_uploaded)
+    upload();
+
+  if (GLEW_ARB_multi_draw_indirect)
+  {
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _buffer);
+    glMultiDrawArraysIndirect(mode, (GLvoid*) 0, get_command_num(), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  }
+  else if (has_base_instance())
+  {
+    for (unsigned i = 0; i != _commands.size(); i += ARRAYS_COMMAND_SIZE)
+      glDrawArraysInstancedBaseInstance(mode, _commands[i + 2], _commands[i], _commands[i + 1], _commands[i + 3]);
+  }
+  else
+  {
+    for (unsigned i = 0; i != _commands.size(); i += ARRAYS_COMMAND_SIZE)
+    {
+      instances.set_first_instance(_commands[i + 3]);
+      glDrawArraysInstanced(mode, _commands[i + 2], _commands[i], _commands[i + 1]);
+    }
+
+    instances.set_first_instance(0);
+  }
+}
+
+
+void
+DrawCommandBuffer::draw_elements(GLenum mode)
+{
+  if (_commands.empty())
+    return;
+
+  if (!_uploaded)
+    upload();
+
+  if (GLEW_ARB_multi_draw_indirect)
+  {
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _buffer);
+    glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, (GLvoid*) 0, get_command_num(), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  }
+  else if (has_base_instance())
+  {
+    for (unsigned i = 0; i != _commands.size(); i += ELEMENTS_COMMAND_SIZE)
+      glDrawElementsInstancedBaseInstance(mode, _commands[i], GL_UNSIGNED_INT,
+                                          (GLvoid*) (_commands[i + 2] * sizeof(GLuint)), _commands[i + 1], _commands[i + 4]);
+  }
+  else
+  {
+    // The base instance of command i only selects the first index attribute
+    for (unsigned i = 0; i != _commands.size(); i += ELEMENTS_COMMAND_SIZE)
+    {
+      if (_first_index_location >= 0)
+        set_first_index_pointer(_commands[i + 4]);
+
+      glDrawElementsInstanced(mode, _commands[i], GL_UNSIGNED_INT,
+                              (GLvoid*) (_commands[i + 2] * sizeof(GLuint)), _commands[i + 1]);
+    }
+
+    if (_first_index_location >= 0)
+      set_first_index_pointer(0);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Reads the first index of every element command as an attribute
+  \remarks The base instance of command i is i, with divisor 1 instance 0 of
+           command i reads the first index field of command i. This gives
+           shaders a per draw value without ARB_shader_draw_parameters.
+*/
+
+void
+DrawCommandBuffer::bind_first_index(unsigned location)
+{
+  _first_index_location = location;
+
+  glEnableVertexAttribArray(location);
+  set_first_index_pointer(0);
+  glVertexAttribDivisor(location, 1);
+}
+
+
+void
+DrawCommandBuffer::unbind_first_index(unsigned location)
+{
+  _first_index_location = -1;
+
+  glVertexAttribDivisor(location, 0);
+  glDisableVertexAttribArray(location);
+}
+
+
+void
+DrawCommandBuffer::set_first_index_pointer(unsigned i_command) const
+{
+  GLsizeiptr offset = (i_command * ELEMENTS_COMMAND_SIZE + 2) * sizeof(GLuint);
+
+  glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+  glVertexAttribIPointer(_first_index_location, 1, GL_UNSIGNED_INT, ELEMENTS_COMMAND_SIZE * sizeof(GLuint), (GLvoid*) offset);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+/*static*/
+bool
+DrawCommandBuffer::has_base_instance()
+{
+  return GLEW_ARB_base_instance || GLEW_VERSION_4_2;
+}
+
+
+void
+DrawCommandBuffer::upload()
+{
+  _uploaded = true;
+
+  if (_commands.empty())
+    return;
+
+  if (!_buffer)
+    glGenBuffers(1, &_buffer);
+
+  // New storage every frame, the commands of the last frame may still be read
+  glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+  glBufferData(GL_ARRAY_BUFFER, _commands.size() * sizeof(GLuint), &_commands[0], GL_STREAM_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+} // namespace vta
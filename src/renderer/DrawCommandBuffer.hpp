@@ -0,0 +1,82 @@
+#ifndef DRAW_COMMAND_BUFFER_HPP
+#define DRAW_COMMAND_BUFFER_HPP
+
+// vta
+#include <renderer/VertexBuffer.hpp>
+
+// cpp
+#include <vector>
+
+// gl
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+
+namespace vta
+{
+
+  // Draw commands collected on the cpu and submitted with one
+  // glMultiDraw*Indirect() call (ARB_multi_draw_indirect), or one base
+  // instance draw per command without it. Without ARB_base_instance the
+  // instance attributes are re-pointed before every draw instead. Holds
+  // either array or element commands, the kind of the first command added
+  // after clear().
+
+  class DrawCommandBuffer
+  {
+    public:
+      // Class constructor
+      DrawCommandBuffer();
+
+      // Class destructor
+      ~DrawCommandBuffer();
+
+      // Remove all commands
+      void clear();
+
+      // Array command (count, instance count, first vertex, base instance)
+      void add_arrays(unsigned, unsigned, unsigned, unsigned);
+
+      // Element command with one instance (count, first index), its base
+      // instance is the index of the command
+      void add_elements(unsigned, unsigned);
+
+      unsigned get_command_num() const;
+
+      // Upload the commands, done by the draw calls if needed
+      void upload();
+
+      // Draw the commands (elements are GL_UNSIGNED_INT), array commands
+      // draw the instances of a vertex buffer (instanced vertex array bound)
+      void draw_arrays(GLenum, VertexBuffer const&);
+      void draw_elements(GLenum);
+
+      // Per instance uint attribute with the first index of the element
+      // command being drawn, on the bound vertex array (after upload())
+      void bind_first_index(unsigned);
+      void unbind_first_index(unsigned);
+
+    private:
+      // Layout of DrawArraysIndirectCommand and DrawElementsIndirectCommand
+      static const unsigned ARRAYS_COMMAND_SIZE = 4;
+      static const unsigned ELEMENTS_COMMAND_SIZE = 5;
+
+      std::vector<GLuint> _commands;
+      unsigned _command_size;
+
+      GLuint _buffer;
+      bool _uploaded;
+
+      // Location of the first index attribute, -1 if not bound
+      int _first_index_location;
+
+      // Point the first index attribute at the first index of a command
+      void set_first_index_pointer(unsigned) const;
+
+      static bool has_base_instance();
+  };
+
+
+} // Namespace vta
+
+#endif // DRAW_COMMAND_BUFFER_HPP
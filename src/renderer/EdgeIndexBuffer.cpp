@@ -0,0 +1,102 @@
+#include "EdgeIndexBuffer.hpp"
+
+
+namespace vta
+{
+
+EdgeIndexBuffer::EdgeIndexBuffer()
+ : _index_buffer(0),
+   _weight_buffer(0),
+   _weight_texture(0),
+   _edge_num(0)
+{}
+
+
+EdgeIndexBuffer::~EdgeIndexBuffer()
+{
+  if (_weight_texture)
+    glDeleteTextures(1, &_weight_texture);
+
+  if (_weight_buffer)
+    glDeleteBuffers(1, &_weight_buffer);
+
+  if (_index_buffer)
+    glDeleteBuffers(1, &_index_buffer);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Uploads the edges
+  \remarks Edge i uses indices 2i and 2i+1 and weight i
+*/
+
+void
+EdgeIndexBuffer::fill(std::vector<uint32_t> const& indices, std::vector<float> const& weights)
+{
+  if (!_index_buffer)
+  {
+    glGenBuffers(1, &_index_buffer);
+    glGenBuffers(1, &_weight_buffer);
+    glGenTextures(1, &_weight_texture);
+  }
+
+  _edge_num = weights.size();
+
+  // The element buffer binding belongs to the bound vertex array
+  glBindVertexArray(0);
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _index_buffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.empty() ? nullptr : &indices[0], GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+  // An empty buffer texture can not be sampled, keep at least one weight
+  std::vector<float> data(weights);
+
+  if (data.empty())
+    data.push_back(0.0f);
+
+  glBindBuffer(GL_TEXTURE_BUFFER, _weight_buffer);
+  glBufferData(GL_TEXTURE_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+  glBindTexture(GL_TEXTURE_BUFFER, _weight_texture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, _weight_buffer);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+
+unsigned
+EdgeIndexBuffer::get_edge_num() const
+{
+  return _edge_num;
+}
+
+
+void
+EdgeIndexBuffer::bind_indices() const
+{
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _index_buffer);
+}
+
+
+void
+EdgeIndexBuffer::bind_weights(unsigned unit) const
+{
+  glActiveTexture(GL_TEXTURE0 + unit);
+  glBindTexture(GL_TEXTURE_BUFFER, _weight_texture);
+  glActiveTexture(GL_TEXTURE0);
+}
+
+
+void
+EdgeIndexBuffer::unbind_weights(unsigned unit) const
+{
+  glActiveTexture(GL_TEXTURE0 + unit);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glActiveTexture(GL_TEXTURE0);
+}
+
+
+} // namespace vta
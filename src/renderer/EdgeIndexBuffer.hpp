@@ -0,0 +1,53 @@
+#ifndef EDGE_INDEX_BUFFER_HPP
+#define EDGE_INDEX_BUFFER_HPP
+
+// cpp
+#include <vector>
+#include <stdint.h>
+
+// gl
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+
+namespace vta
+{
+
+  // Edges as pairs of 32 bit vertex indices into the node vertex buffer
+  // (element buffer) and one weight per edge in a buffer texture (R32F), read
+  // by the fragment shader through gl_PrimitiveID. Node positions are not
+  // copied, moving nodes does not touch the edges.
+
+  class EdgeIndexBuffer
+  {
+    public:
+      // Class constructor
+      EdgeIndexBuffer();
+
+      // Class destructor
+      ~EdgeIndexBuffer();
+
+      // Upload two indices and one weight per edge
+      void fill(std::vector<uint32_t> const&, std::vector<float> const&);
+
+      unsigned get_edge_num() const;
+
+      // Bind the element buffer to the bound vertex array
+      void bind_indices() const;
+
+      // Bind the weights to a texture unit (GL_TEXTURE0 + unit)
+      void bind_weights(unsigned) const;
+      void unbind_weights(unsigned) const;
+
+    private:
+      GLuint _index_buffer;
+      GLuint _weight_buffer;
+      GLuint _weight_texture;
+
+      unsigned _edge_num;
+  };
+
+
+} // Namespace vta
+
+#endif // EDGE_INDEX_BUFFER_HPP
@@ -0,0 +1,271 @@
+#include "LabelPlacer.hpp"
+
+// cpp
+#include <algorithm>
+#include <cmath>
+
+
+namespace vta
+{
+
+namespace
+{
+  // Grid cell size in pixels
+  const float CELL_SIZE = 32.0f;
+
+  // Distance between node and label in pixels
+  const float LABEL_GAP = 4.0f;
+
+  // Stop after this many nodes in a row did not fit (plus the number of placed labels)
+  const unsigned MIN_FAILED_RUN = 128;
+}
+
+
+LabelPlacer::LabelPlacer()
+ : _glyph_width(14.0f),
+   _glyph_height(24.0f),
+   _text(nullptr),
+   _ranked_cluster(nullptr),
+   _ranking(),
+   _cluster(nullptr),
+   _filter(nullptr),
+   _scale(0.0f),
+   _offset_x(0.0f),
+   _offset_y(0.0f),
+   _width(0),
+   _height(0),
+   _visits(),
+   _labels(),
+   _grid_width(0),
+   _grid_height(0),
+   _grid(),
+   _boxes()
+{}
+
+
+LabelPlacer::~LabelPlacer()
+{}
+
+
+void
+LabelPlacer::set_glyph_size(float width, float height)
+{
+  _glyph_width = width;
+  _glyph_height = height;
+
+  invalidate();
+}
+
+
+void
+LabelPlacer::set_text_renderer(TextRenderer const* text)
+{
+  _text = text;
+
+  invalidate();
+}
+
+
+void
+LabelPlacer::invalidate()
+{
+  _cluster = nullptr;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Places the labels of a cluster
+  \remarks Returns the cached labels if nothing they depend on changed
+*/
+
+std::vector<LabelPlacer::Label> const&
+LabelPlacer::place(Cluster* cluster, FilterEngine const* filter,
+                   float scale, float offset_x, float offset_y, int width, int height)
+{
+  if (is_valid(cluster, filter, scale, offset_x, offset_y, width, height))
+    return _labels;
+
+  rank(cluster);
+
+  _cluster = cluster;
+  _filter = filter;
+  _scale = scale;
+  _offset_x = offset_x;
+  _offset_y = offset_y;
+  _width = width;
+  _height = height;
+
+  _visits.clear();
+  _labels.clear();
+  _boxes.clear();
+
+  _grid_width = std::max(1, (int) ceil(width / CELL_SIZE));
+  _grid_height = std::max(1, (int) ceil(height / CELL_SIZE));
+  _grid.assign(_grid_width * _grid_height, std::vector<unsigned>());
+
+  float label_height = _text ? _text->get_line_height() : _glyph_height;
+
+  unsigned failed_run = 0;
+
+  for (unsigned i_rank = 0; i_rank != _ranking.size(); ++i_rank)
+  {
+    if (failed_run > MIN_FAILED_RUN + _labels.size())
+      break;
+
+    unsigned i_node = _ranking[i_rank];
+    Node* current_node = cluster->get_node(i_node);
+
+    Visit visit;
+    visit.node = i_node;
+    visit.x = current_node->_x;
+    visit.y = current_node->_y;
+    visit.visible = !filter || filter->is_node_visible(current_node->_id);
+
+    _visits.push_back(visit);
+
+    if (!visit.visible)
+      continue;
+
+    float screen_x = visit.x * scale + offset_x;
+    float screen_y = visit.y * scale + offset_y;
+
+    float label_width = _text ? _text->get_text_width(current_node->_label) : current_node->_label.size() * _glyph_width;
+
+    // Right above, right below, left above, left below
+    Box candidates[4] =
+    {
+      { screen_x + LABEL_GAP,               screen_y + LABEL_GAP,                screen_x + LABEL_GAP + label_width, screen_y + LABEL_GAP + label_height },
+      { screen_x + LABEL_GAP,               screen_y - LABEL_GAP - label_height, screen_x + LABEL_GAP + label_width, screen_y - LABEL_GAP },
+      { screen_x - LABEL_GAP - label_width, screen_y + LABEL_GAP,                screen_x - LABEL_GAP,               screen_y + LABEL_GAP + label_height },
+      { screen_x - LABEL_GAP - label_width, screen_y - LABEL_GAP - label_height, screen_x - LABEL_GAP,               screen_y - LABEL_GAP }
+    };
+
+    bool placed = false;
+
+    for (unsigned i_candidate = 0; i_candidate != 4 && !placed; ++i_candidate)
+    {
+      if (insert(candidates[i_candidate]))
+      {
+        Label label = { i_node, candidates[i_candidate].min_x, candidates[i_candidate].min_y };
+        _labels.push_back(label);
+
+        placed = true;
+      }
+    }
+
+    failed_run = placed ? 0 : failed_run + 1;
+  }
+
+  return _labels;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Nodes sorted by degree, then by mean edge weight
+  \remarks Needs Cluster::compute_statistics()
+*/
+
+void
+LabelPlacer::rank(Cluster* cluster)
+{
+  if (cluster == _ranked_cluster)
+    return;
+
+  _ranked_cluster = cluster;
+  _ranking.resize(cluster->get_node_num());
+
+  for (unsigned i_node = 0; i_node != _ranking.size(); ++i_node)
+    _ranking[i_node] = i_node;
+
+  std::stable_sort(_ranking.begin(), _ranking.end(), [cluster](unsigned a, unsigned b)
+  {
+    if (cluster->get_node_degree(a) != cluster->get_node_degree(b))
+      return cluster->get_node_degree(a) > cluster->get_node_degree(b);
+
+    return cluster->get_node_mean_weight(a) > cluster->get_node_mean_weight(b);
+  });
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Checks if the cached placement still holds
+  \remarks Only the visited nodes are compared, nodes after the last visited
+           one never influenced the placement
+*/
+
+bool
+LabelPlacer::is_valid(Cluster* cluster, FilterEngine const* filter,
+                      float scale, float offset_x, float offset_y, int width, int height) const
+{
+  if (cluster != _cluster || filter != _filter || scale != _scale ||
+      offset_x != _offset_x || offset_y != _offset_y || width != _width || height != _height)
+    return false;
+
+  for (unsigned i_visit = 0; i_visit != _visits.size(); ++i_visit)
+  {
+    Visit const& visit = _visits[i_visit];
+    Node* current_node = cluster->get_node(visit.node);
+
+    if ((float) current_node->_x != visit.x || (float) current_node->_y != visit.y)
+      return false;
+
+    if (visit.visible != (!filter || filter->is_node_visible(current_node->_id)))
+      return false;
+  }
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Inserts the box if it is on screen and overlaps no placed box
+*/
+
+bool
+LabelPlacer::insert(Box const& box)
+{
+  if (box.min_x < 0.0f || box.min_y < 0.0f || box.max_x > _width || box.max_y > _height)
+    return false;
+
+  unsigned min_cell_x = box.min_x / CELL_SIZE;
+  unsigned min_cell_y = box.min_y / CELL_SIZE;
+  unsigned max_cell_x = std::min(_grid_width - 1, (unsigned) (box.max_x / CELL_SIZE));
+  unsigned max_cell_y = std::min(_grid_height - 1, (unsigned) (box.max_y / CELL_SIZE));
+
+  for (unsigned cell_y = min_cell_y; cell_y <= max_cell_y; ++cell_y)
+  {
+    for (unsigned cell_x = min_cell_x; cell_x <= max_cell_x; ++cell_x)
+    {
+      std::vector<unsigned> const& cell = _grid[cell_y * _grid_width + cell_x];
+
+      for (unsigned i_box = 0; i_box != cell.size(); ++i_box)
+      {
+        Box const& other = _boxes[cell[i_box]];
+
+        if (box.min_x < other.max_x && other.min_x < box.max_x &&
+            box.min_y < other.max_y && other.min_y < box.max_y)
+          return false;
+      }
+    }
+  }
+
+  unsigned index = _boxes.size();
+  _boxes.push_back(box);
+
+  for (unsigned cell_y = min_cell_y; cell_y <= max_cell_y; ++cell_y)
+    for (unsigned cell_x = min_cell_x; cell_x <= max_cell_x; ++cell_x)
+      _grid[cell_y * _grid_width + cell_x].push_back(index);
+
+  return true;
+}
+
+
+} // namespace vta
@@ -0,0 +1,112 @@
+#ifndef LABEL_PLACER_HPP
+#define LABEL_PLACER_HPP
+
+// vta
+#include <cluster/Cluster.hpp>
+#include <filter/FilterEngine.hpp>
+#include <renderer/TextRenderer.hpp>
+
+// cpp
+#include <vector>
+
+
+namespace vta
+{
+
+  // Greedy label placement for the nodes of one cluster. Nodes are ranked by
+  // degree (then mean edge weight), every node tries four boxes around its
+  // position and gets the first one that overlaps no placed label. Placed
+  // boxes are kept in a screen space grid, so a test only looks at nearby
+  // labels. Label boxes are measured with the text renderer that draws them,
+  // or estimated from a glyph size without one.
+  // Placement stops after a run of nodes that did not fit, the cost
+  // follows the number of labels on screen and not the cluster size.
+  // The result is cached and only recomputed if the view, the filter or one of
+  // the visited nodes changed.
+
+  class LabelPlacer
+  {
+    public:
+      // Label at screen position of its lower left corner
+      struct Label
+      {
+        unsigned node;
+        float x;
+        float y;
+      };
+
+      // Class constructor
+      LabelPlacer();
+
+      // Class destructor
+      ~LabelPlacer();
+
+      // Estimated glyph size in pixels (average width and line height)
+      void set_glyph_size(float, float);
+
+      // Measure the labels with the font of a text renderer (initialized),
+      // nullptr uses the glyph size
+      void set_text_renderer(TextRenderer const*);
+
+      // Labels of the cluster for screen = world * scale + offset
+      std::vector<Label> const& place(Cluster*, FilterEngine const*,
+                                      float, float, float, int, int);
+
+      // Forget the cached placement
+      void invalidate();
+
+    private:
+      struct Box
+      {
+        float min_x;
+        float min_y;
+        float max_x;
+        float max_y;
+      };
+
+      // Visited node with the state the placement depended on
+      struct Visit
+      {
+        unsigned node;
+        float x;
+        float y;
+        bool visible;
+      };
+
+      float _glyph_width;
+      float _glyph_height;
+      TextRenderer const* _text;
+
+      // Nodes by rank, cached per cluster
+      Cluster* _ranked_cluster;
+      std::vector<unsigned> _ranking;
+
+      // View of the cached placement
+      Cluster* _cluster;
+      FilterEngine const* _filter;
+      float _scale;
+      float _offset_x;
+      float _offset_y;
+      int _width;
+      int _height;
+
+      std::vector<Visit> _visits;
+      std::vector<Label> _labels;
+
+      // Screen grid: boxes overlapping every cell
+      unsigned _grid_width;
+      unsigned _grid_height;
+      std::vector<std::vector<unsigned> > _grid;
+      std::vector<Box> _boxes;
+
+      void rank(Cluster*);
+      bool is_valid(Cluster*, FilterEngine const*, float, float, float, int, int) const;
+
+      // Try to insert a box into the grid
+      bool insert(Box const&);
+  };
+
+
+} // Namespace vta
+
+#endif // LABEL_PLACER_HPP
@@ -1,5 +1,8 @@
 #include "OverviewRenderer.h"
 
+// vta
+#include <util/FrameProfiler.hpp>
+
 // gloost
 #include <gloost/BinaryFile.h>
 #include <gloost/gloostHelper.h>
@@ -59,29 +62,71 @@ OverviewRenderer::OverviewRenderer(Visualization* graph):
 
   _graph(graph),
 
-  _max_similarity(1.0),
-  _min_similarity(0.64),
+  _blacklist(graph),
+  _filter(graph),
+  _vbos_dirty(false),
+  _positions_dirty(false),
+  _layout_worker(graph),
+  _layout_running(false),
+
+  _edge_bundles(),
+  _bundle_edges(false),
+
+  _vbo_clusters(),
+  _cluster_node_offsets(1, 0),
+  _node_slots(),
+
+  _edge_bucket_offsets(SimilarityIndex::BUCKET_NUM + 1, 0),
+  _edges_bundled(false),
+
+  _cluster_edge_offsets(1, 0),
+  _edge_indices(),
+
+  _visible_clusters(),
+  _node_commands(),
+  _edge_commands(),
+
+  _draw_impostors(true),
+  _impostor_clusters(),
+  _impostor_commands(),
+  _cluster_visible_nodes(),
 
-  _blacklist(),
+  _density(),
+  _density_edges(false),
+  _gradient_index(0),
+
+  _node_visibility(),
+  _edge_visibility(),
+  _node_slot_words(),
+  _edge_slot_words(),
 
   _uniformSet(),
   _edgeShader(nullptr),
+  _indexedEdgeShader(nullptr),
   _nodeShader(nullptr),
-  _typeWriter(nullptr),
+  _impostorShader(nullptr),
 
-  _vboNodes(nullptr),
-  _vboEdges(nullptr),
+  _vboNodes(),
+  _vboEdges(),
+  _vboImpostors(),
+  _text(),
 
   _highlight_at_mouse_over(false),
-  _cluster_node_vbo(),
-  _cluster_edge_vbo(),
 
-  _num_clusters_on_screen(0)
+  _node_grids(),
+  _node_grid_versions(),
+  _hovering(false),
+  _hover_cluster(0),
+  _hover_node(0),
+  _highlight_dirty(false),
+  _highlight_layout_version(0),
+  _vboHighlightNodes(),
+  _vboHighlightEdges(),
+
+  _num_clusters_on_screen(0),
+  _drawn_node_num(0),
+  _drawn_edge_num(0)
 {
-
-  // create TypeWriter
-  _typeWriter = gloost::FreeTypeWriter::create("../../res/fonts/Verdana.ttf", 12.0f, true);
-
   // set projection matrix
   _projectionMatrix.setIdentity();
   _viewMatrix.setIdentity();
@@ -102,6 +147,10 @@ OverviewRenderer::OverviewRenderer(Visualization* graph):
   _uniformSet.set_mat4("View", gloost::mat4(_viewMatrix));
 
   std::srand(std::time(0)); // use current time as seed for random generator
+
+  // Initial similarity window
+  _filter.set_minimum_similarity(0.64);
+  _filter.set_maximum_similarity(1.0);
 }
 
 
@@ -118,6 +167,16 @@ OverviewRenderer::~OverviewRenderer()
 }
 
 
+namespace
+{
+  // Gradients of the edge density, selected with key G
+  const std::string GRADIENT_PATH = "../../res/gradients/";
+  const std::string GRADIENTS[] = { "black_blue_red_yellow.png", "black_green_yellow_red.png", "green_yellow_red.png",
+                                    "black_green_white.png", "blue_white.png", "blue_purple.png", "rainbow.png", "rainbow_alpha.png" };
+  const unsigned GRADIENT_NUM = sizeof(GRADIENTS) / sizeof(GRADIENTS[0]);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -130,30 +189,39 @@ OverviewRenderer::initialize()
 {
   std::cout << "Number of clusters: " << _graph->get_cluster_num() << std::endl;
 
-  for (unsigned i = 0; i != _graph->get_cluster_num(); ++i)
-  {
-    Cluster* current_cluster = _graph->get_cluster_by_index(i);
-
-    // Initial layout
-    current_cluster->make_radial_layout();
-
-//    create_cluster_node_vbo(current_cluster);
-//    create_cluster_edge_vbo(current_cluster);
-  }
+  // Initial layout
+  _graph->make_layout(Visualization::RADIAL_LAYOUT);
 
-  std::cout << "Number of cluster vbos: " << _cluster_node_vbo.size() << std::endl;
+  // Every node is visible until the blacklist gets entries
+  _blacklist.update_visibility();
+  _filter.update();
 
   // create shader program and attach all components
   _edgeShader = gloost::gl::ShaderProgram::create();
   _edgeShader->attachShader(GLOOST_SHADERPROGRAM_VERTEX_SHADER,   "../../shaders/edge.vs");
   _edgeShader->attachShader(GLOOST_SHADERPROGRAM_FRAGMENT_SHADER, "../../shaders/edge.fs");
 
+  // create shader program and attach all components
+  _indexedEdgeShader = gloost::gl::ShaderProgram::create();
+  _indexedEdgeShader->attachShader(GLOOST_SHADERPROGRAM_VERTEX_SHADER,   "../../shaders/indexed_edge.vs");
+  _indexedEdgeShader->attachShader(GLOOST_SHADERPROGRAM_FRAGMENT_SHADER, "../../shaders/indexed_edge.fs");
+
   // create shader program and attach all components
   _nodeShader = gloost::gl::ShaderProgram::create();
   _nodeShader->attachShader(GLOOST_SHADERPROGRAM_VERTEX_SHADER,   "../../shaders/node.vs");
-  _nodeShader->attachShader(GLOOST_SHADERPROGRAM_GEOMETRY_SHADER, "../../shaders/node.gs");
   _nodeShader->attachShader(GLOOST_SHADERPROGRAM_FRAGMENT_SHADER, "../../shaders/node.fs");
 
+  // create shader program and attach all components
+  _impostorShader = gloost::gl::ShaderProgram::create();
+  _impostorShader->attachShader(GLOOST_SHADERPROGRAM_VERTEX_SHADER,   "../../shaders/impostor.vs");
+  _impostorShader->attachShader(GLOOST_SHADERPROGRAM_FRAGMENT_SHADER, "../../shaders/impostor.fs");
+
+  _density.initialize();
+  _density.load_gradient(GRADIENT_PATH + GRADIENTS[_gradient_index]);
+
+  _text.initialize("../../res/fonts/Verdana.ttf", 12.0f);
+  _text.set_color(0.0f, 1.0f, 0.0f, 1.0f);
+
   // Fill vbos with new positions
   fill_vbo_nodes();
   fill_vbo_edges();
@@ -164,222 +232,450 @@ OverviewRenderer::initialize()
 }
 
 
+namespace
+{
+  // Half edge length of the node quads in clip space
+  const float NODE_SIZE = 0.002f;
+
+  // Clusters with a smaller radius on screen (pixels) are drawn as impostors
+  const double LOD_PIXEL_RADIUS = 6.0;
+
+  // Minimum distance of a picked node to the mouse in pixels
+  const double PICK_PIXEL_RADIUS = 4.0;
+
+
+  // Node vertices of a cluster: vec2(position) + vec3(color)
+  void write_cluster_nodes(Cluster* cluster, std::vector<float>& vertices)
+  {
+    vertices.resize(cluster->get_node_num() * 5);
+
+    unsigned vboIdx = 0;
+
+    for (unsigned i = 0; i != cluster->get_node_num(); ++i)
+    {
+      Node* current_node = cluster->get_node(i);
+
+      vertices[vboIdx++] = current_node->_x; // node x
+      vertices[vboIdx++] = current_node->_y; // node y
+
+      vertices[vboIdx++] = current_node->_color[0]; // node color r
+      vertices[vboIdx++] = current_node->_color[1]; // node color g
+      vertices[vboIdx++] = current_node->_color[2]; // node color b
+    }
+  }
+
+
+  // Impostor of a cluster: vec2(position) + float(bounding radius) + vec3(color).
+  // The color is the mean node color, tinted with the edge color of the
+  // mean edge weight by the share of edges per node.
+  void write_cluster_impostor(Cluster* cluster, std::vector<float>& vertex)
+  {
+    vertex.resize(6);
+
+    float color[3] = { 0.0f, 0.0f, 0.0f };
+
+    for (unsigned i = 0; i != cluster->get_node_num(); ++i)
+    {
+      Node* current_node = cluster->get_node(i);
+
+      color[0] += current_node->_color[0];
+      color[1] += current_node->_color[1];
+      color[2] += current_node->_color[2];
+    }
+
+    if (cluster->get_node_num() != 0)
+    {
+      color[0] /= cluster->get_node_num();
+      color[1] /= cluster->get_node_num();
+      color[2] /= cluster->get_node_num();
+    }
+
+    float edge_share = cluster->get_node_num() != 0 ? std::min(1.0f, (float) cluster->get_edge_num() / cluster->get_node_num()) : 0.0f;
+
+    // Same color as Edge::_color
+    float edge_color[3] = { 0.0f, 0.0f, cluster->get_mean_edge_weight() };
+
+    vertex[0] = cluster->get_position_x();
+    vertex[1] = cluster->get_position_y();
+    vertex[2] = cluster->get_bounding_radius();
+
+    for (unsigned i = 0; i != 3; ++i)
+      vertex[3 + i] = color[i] + 0.5f * edge_share * (edge_color[i] - color[i]);
+  }
+
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
-  \brief   Add new node-vbo for new cluster
-  \remarks ...
+  \brief   Fills the nodes-vbo with all nodes of _graph
+  \remarks Nodes are written cluster by cluster, so the nodes of a cluster are
+           one range of the vbo and a relayout only rewrites that range (see
+           update_vbo_positions). Hidden nodes are written as well, the node
+           shader culls them with _node_visibility.
 */
 
 void
-OverviewRenderer::create_cluster_node_vbo(Cluster* current_cluster)
+OverviewRenderer::fill_vbo_nodes()
 {
-  std::shared_ptr<gloost::gl::Vbo4> vboNodes;
+  FrameProfiler::CpuScope cpu_scope("fill_vbo_nodes");
 
-  // init nodes
-  int numNodes = current_cluster->get_node_num();
+  unsigned numClusters = _graph->get_cluster_num();
 
-  auto interleavedAttributes = gloost::InterleavedAttributes::create();
+  _vbo_clusters.resize(numClusters);
+  _cluster_node_offsets.assign(numClusters + 1, 0);
+  _node_slots.assign(_graph->get_node_num(), 0);
 
-  unsigned containerSize = numNodes * 5; // vec2(position) + vec3(color)
-  std::vector<float>& container = interleavedAttributes->getVector();
-  container = std::vector<float>(containerSize, 0.0f);
+  for (unsigned i_cluster = 0; i_cluster != numClusters; ++i_cluster)
+  {
+    Cluster* cluster = _graph->get_cluster_by_index(i_cluster);
 
-  // tell the vertex attribute container which attributes are contained
-  interleavedAttributes->addAttribute(2, 8, "in_position");
-  interleavedAttributes->addAttribute(3, 12, "in_color");
+    _vbo_clusters[i_cluster] = cluster;
+    _cluster_node_offsets[i_cluster + 1] = _cluster_node_offsets[i_cluster] + cluster->get_node_num();
 
-  unsigned vboIdx = 0;
+    for (unsigned i = 0; i != cluster->get_node_num(); ++i)
+      _node_slots[cluster->get_node(i)->_id] = _cluster_node_offsets[i_cluster] + i;
+  }
+
+  // in_position, in_color
+  _vboNodes.set_format(std::vector<unsigned>{2, 3});
+  _vboNodes.resize(_cluster_node_offsets[numClusters]);
+
+  // Node grids are built on first use, the hovered node may be gone
+  _node_grids.assign(numClusters, NodeGrid());
+  _node_grid_versions.assign(numClusters, 0);
+
+  _hovering = false;
+  _highlight_dirty = true;
+
+  // in_position, in_color
+  _vboHighlightNodes.set_format(std::vector<unsigned>{2, 3});
+  // in_position, in_color, in_similarity
+  _vboHighlightEdges.set_format(std::vector<unsigned>{2, 3, 1});
 
-  for (unsigned i = 0; i != numNodes; ++i)
+  // in_center, in_radius, in_color
+  _vboImpostors.set_format(std::vector<unsigned>{2, 1, 3});
+  _vboImpostors.resize(numClusters);
+
+  std::vector<float> vertices;
+
+  for (unsigned i_cluster = 0; i_cluster != numClusters; ++i_cluster)
   {
-    Node* current_node = current_cluster->get_node(i);
+    write_cluster_nodes(_vbo_clusters[i_cluster], vertices);
+    _vboNodes.write(_cluster_node_offsets[i_cluster], vertices);
+
+    write_cluster_impostor(_vbo_clusters[i_cluster], vertices);
+    _vboImpostors.write(i_cluster, vertices);
+  }
+
+  update_node_visibility();
+}
 
-    std::string title = current_node->_label;
 
-    if (!blacklist_constains(title))
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Fills the edge index buffer with all edges of _graph
+  \remarks Edges are index pairs into the node vbo (see fill_vbo_nodes) plus
+           one weight. They are written cluster by cluster in the cluster
+           order of the node vbo, inside a cluster in similarity order, so
+           the similarity window of a cluster is one range. Hidden edges are
+           written as well, the edge shader culls them with _edge_visibility.
+*/
+
+void
+OverviewRenderer::fill_vbo_edges()
+{
+  FrameProfiler::CpuScope cpu_scope("fill_vbo_edges");
+
+  if (_bundle_edges && !_layout_worker.is_running())
+  {
+    fill_vbo_bundles();
+    return;
+  }
+
+  unsigned numClusters = _vbo_clusters.size();
+
+  _cluster_edge_offsets.assign(numClusters + 1, 0);
+
+  for (unsigned i_cluster = 0; i_cluster != numClusters; ++i_cluster)
+    _cluster_edge_offsets[i_cluster + 1] = _cluster_edge_offsets[i_cluster] + _vbo_clusters[i_cluster]->get_similarity_index().get_edge_num();
+
+  unsigned numEdges = _cluster_edge_offsets[numClusters];
+
+  std::vector<uint32_t> indices(numEdges * 2);
+  std::vector<float> weights(numEdges);
+
+  for (unsigned i_cluster = 0; i_cluster != numClusters; ++i_cluster)
+  {
+    SimilarityIndex const& similarity_index = _vbo_clusters[i_cluster]->get_similarity_index();
+
+    for (unsigned i = 0; i != similarity_index.get_edge_num(); ++i)
     {
-      container[vboIdx++] = current_node->_x; // node x
-      container[vboIdx++] = current_node->_y; // node y
+      Edge* current_edge = similarity_index.get_edge(i);
+
+      unsigned slot = _cluster_edge_offsets[i_cluster] + i;
+
+      indices[2 * slot]     = _node_slots[current_edge->getSource()->_id];
+      indices[2 * slot + 1] = _node_slots[current_edge->getTarget()->_id];
 
-      container[vboIdx++] = current_node->_color[0]; // node color r
-      container[vboIdx++] = current_node->_color[1]; // node color g
-      container[vboIdx++] = current_node->_color[2]; // node color b
+      weights[slot] = current_edge->getWeight();
     }
   }
-  vboNodes = gloost::gl::Vbo4::create(interleavedAttributes);
 
-  _cluster_node_vbo.push_back(vboNodes);
+  _edge_indices.fill(indices, weights);
+
+  // Bundle segments are not needed anymore
+  _vboEdges.resize(0);
+
+  _edges_bundled = false;
+
+  update_edge_visibility();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Rewrites the vbo ranges of clusters whose nodes moved
+  \remarks Clusters are compared with their vertices in the vbo, only changed
+           ranges are uploaded. Edges only refer to the nodes and stay as
+           they are, bundles are rebuilt. Everything is refilled if the
+           clusters were reordered.
+*/
+
+void
+OverviewRenderer::update_vbo_positions()
+{
+  FrameProfiler::CpuScope cpu_scope("update_vbo_positions");
+
+  unsigned numClusters = _graph->get_cluster_num();
+
+  bool same_clusters = (numClusters == _vbo_clusters.size());
+
+  for (unsigned i_cluster = 0; i_cluster != numClusters && same_clusters; ++i_cluster)
+    same_clusters = (_graph->get_cluster_by_index(i_cluster) == _vbo_clusters[i_cluster]);
+
+  if (!same_clusters)
+  {
+    fill_vbo_nodes();
+    fill_vbo_edges();
+    return;
+  }
+
+  std::vector<float> vertices;
+
+  for (unsigned i_cluster = 0; i_cluster != numClusters; ++i_cluster)
+  {
+    write_cluster_nodes(_vbo_clusters[i_cluster], vertices);
+    _vboNodes.update(_cluster_node_offsets[i_cluster], vertices);
+
+    write_cluster_impostor(_vbo_clusters[i_cluster], vertices);
+    _vboImpostors.update(i_cluster, vertices);
+  }
+
+  if (_edges_bundled)
+    fill_vbo_bundles();
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
-  \brief   Add new edge-vbo for new cluster
-  \remarks ...
+  \brief   Fill the edge vbo with bundled edges
+  \remarks Bundles are rebuilt for the current positions, of all edges. Every
+           shared segment is one line, sorted by similarity bucket like the
+           single edges, so the similarity window still selects a range.
+           Filters only hide segments (see update_edge_visibility).
 */
 
 void
-OverviewRenderer::create_cluster_edge_vbo(Cluster* current_cluster)
+OverviewRenderer::fill_vbo_bundles()
 {
-  std::shared_ptr<gloost::gl::Vbo4> vboEdge;
+  FrameProfiler::CpuScope cpu_scope("fill_vbo_bundles");
 
-  int numEdges = current_cluster->get_edge_num();
+  _edge_bundles.build(_graph, nullptr);
 
-  auto interleavedAttributes = gloost::InterleavedAttributes::create();
+  unsigned numSegments = _edge_bundles.get_segment_num();
 
-  unsigned containerSize = numEdges * 10; // vec2 * 2 + vec3 * 2
-  std::vector<float>& container = interleavedAttributes->getVector();
-  container = std::vector<float>(containerSize, 0.0f);
+  // in_position, in_color, in_similarity
+  _vboEdges.set_format(std::vector<unsigned>{2, 3, 1});
+  _vboEdges.resize(numSegments * 2);
 
-  // tell the vertex attribute container which attributes are contained
-  interleavedAttributes->addAttribute(2, 8, "in_position");
-  interleavedAttributes->addAttribute(3, 12, "in_color");
+  std::vector<float> container(numSegments * 12, 0.0f); // (vec2 + vec3 + float) * 2
 
   unsigned vboIdx = 0;
 
-  for (unsigned i = 0; i != numEdges; ++i)
+  for (unsigned i_segment = 0; i_segment != numSegments; ++i_segment)
   {
-    Edge* current_edge = current_cluster->get_edge(i);
+    EdgeBundles::Segment const& segment = _edge_bundles.get_segment(i_segment);
 
-    Node* source = current_edge->getSource();
-    Node* target = current_edge->getTarget();
+    container[vboIdx++] = _edge_bundles.get_point_x(segment.first);
+    container[vboIdx++] = _edge_bundles.get_point_y(segment.first);
 
-    std::string title_source = source->_label;
-    std::string title_target = target->_label;
+    container[vboIdx++] = segment.color[0];
+    container[vboIdx++] = segment.color[1];
+    container[vboIdx++] = segment.color[2];
 
-    if (!blacklist_constains(title_source) && !blacklist_constains(title_target))
-    {
-      double similarity = current_edge->getWeight();
+    container[vboIdx++] = segment.similarity;
 
-      if (similarity >= _min_similarity && similarity <= _max_similarity)
-      {
-        container[vboIdx++] = source->_x; // source x
-        container[vboIdx++] = source->_y; // source y
+    container[vboIdx++] = _edge_bundles.get_point_x(segment.second);
+    container[vboIdx++] = _edge_bundles.get_point_y(segment.second);
 
-        container[vboIdx++] = current_edge->_color[0]; // edge color r
-        container[vboIdx++] = current_edge->_color[1]; // edge color g
-        container[vboIdx++] = current_edge->_color[2]; // edge color b
+    container[vboIdx++] = segment.color[0];
+    container[vboIdx++] = segment.color[1];
+    container[vboIdx++] = segment.color[2];
 
-        container[vboIdx++] = target->_x; // target x
-        container[vboIdx++] = target->_y; // target y
-
-        container[vboIdx++] = current_edge->_color[0]; // edge color r
-        container[vboIdx++] = current_edge->_color[1]; // edge color g
-        container[vboIdx++] = current_edge->_color[2]; // edge color b
-      }
-    }
+    container[vboIdx++] = segment.similarity;
   }
 
-  vboEdge = gloost::gl::Vbo4::create(interleavedAttributes);
+  _vboEdges.write(0, container);
 
-  _cluster_edge_vbo.push_back(vboEdge);
+  for (unsigned i_bucket = 0; i_bucket != SimilarityIndex::BUCKET_NUM + 1; ++i_bucket)
+    _edge_bucket_offsets[i_bucket] = _edge_bundles.get_bucket_offset(i_bucket);
+
+  _edges_bundled = true;
+
+  update_edge_visibility();
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
-  \brief   Fills the nodes-vbo with all nodes of _graph
-  \remarks ...
+  \brief   Uploads the node and edge visibility of the filter
+  \remarks Only changed words are uploaded, the vbos are not touched. Slots
+           follow the vbos, their bits are gathered from the filter bitmaps.
+           A bundle segment is visible if one of its edges is.
 */
 
 void
-OverviewRenderer::fill_vbo_nodes()
+OverviewRenderer::update_visibility()
 {
-  // init nodes
-  int numNodes = _graph->get_node_num();
+  FrameProfiler::CpuScope cpu_scope("update_visibility");
 
-  auto interleavedAttributes = gloost::InterleavedAttributes::create();
+  update_node_visibility();
+  update_edge_visibility();
+}
 
-  unsigned containerSize = numNodes * 5; // vec2(position) + vec3(color)
-  std::vector<float>& container = interleavedAttributes->getVector();
-  container = std::vector<float>(containerSize, 0.0f);
 
-  // tell the vertex attribute container which attributes are contained
-  interleavedAttributes->addAttribute(2, 8, "in_position");
-  interleavedAttributes->addAttribute(3, 12, "in_color");
+void
+OverviewRenderer::update_node_visibility()
+{
+  _node_slot_words.assign((_cluster_node_offsets.back() + 63) / 64, 0);
+  _cluster_visible_nodes.assign(_vbo_clusters.size(), 0);
+
+  for (unsigned i_cluster = 0; i_cluster != _vbo_clusters.size(); ++i_cluster)
+  {
+    Cluster* cluster = _vbo_clusters[i_cluster];
+
+    for (unsigned i = 0; i != cluster->get_node_num(); ++i)
+    {
+      unsigned slot = _cluster_node_offsets[i_cluster] + i;
+
+      if (_filter.is_node_visible(cluster->get_node(i)->_id))
+      {
+        _node_slot_words[slot / 64] |= uint64_t(1) << (slot % 64);
+        ++_cluster_visible_nodes[i_cluster];
+      }
+    }
+  }
+
+  _node_visibility.update(_node_slot_words);
+}
 
-  unsigned vboIdx = 0;
 
-  for (unsigned i = 0; i != numNodes; ++i)
+void
+OverviewRenderer::update_edge_visibility()
+{
+  if (_edges_bundled)
   {
-    Node* current_node = _graph->get_node_by_index(i);
+    _edge_bundles.get_visible_segments(_filter, _edge_slot_words);
+    _edge_visibility.update(_edge_slot_words);
+    return;
+  }
 
-    std::string title = current_node->_label;
+  _edge_slot_words.assign((_cluster_edge_offsets.back() + 63) / 64, 0);
+
+  for (unsigned i_cluster = 0; i_cluster != _vbo_clusters.size(); ++i_cluster)
+  {
+    SimilarityIndex const& similarity_index = _vbo_clusters[i_cluster]->get_similarity_index();
 
-    if (!blacklist_constains(title))
+    for (unsigned i = 0; i != similarity_index.get_edge_num(); ++i)
     {
-      container[vboIdx++] = current_node->_x; // node x
-      container[vboIdx++] = current_node->_y; // node y
+      unsigned slot = _cluster_edge_offsets[i_cluster] + i;
 
-      container[vboIdx++] = current_node->_color[0]; // node color r
-      container[vboIdx++] = current_node->_color[1]; // node color g
-      container[vboIdx++] = current_node->_color[2]; // node color b
+      if (_filter.is_edge_visible(similarity_index.get_edge(i)->getIndex()))
+        _edge_slot_words[slot / 64] |= uint64_t(1) << (slot % 64);
     }
   }
-  _vboNodes = gloost::gl::Vbo4::create(interleavedAttributes);
+
+  _edge_visibility.update(_edge_slot_words);
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
-  \brief   Fills the edges-vbo with all edges of _graph
-  \remarks ...
+  \brief   Collects the clusters that overlap the viewport
+  \remarks Candidates come from the shelf index of the graph, they are tested
+           with the bounding circle of the cluster (its position and the
+           distance of its farthest node plus the node quad size). Indices
+           are valid for _vbo_clusters, which has the cluster order of the
+           graph. Clusters with a bounding radius below LOD_PIXEL_RADIUS on
+           screen go to _impostor_clusters instead, unless all of their nodes
+           are hidden.
 */
 
 void
-OverviewRenderer::fill_vbo_edges()
+OverviewRenderer::collect_visible_clusters()
 {
-  int numEdges = _graph->get_edge_num();
+  double min_x = (0.0 - _translateVector[0]) / _scaleVector[0];
+  double min_y = (0.0 - _translateVector[1]) / _scaleVector[1];
+  double max_x = (_width - _translateVector[0]) / _scaleVector[0];
+  double max_y = (_height - _translateVector[1]) / _scaleVector[1];
 
-  auto interleavedAttributes = gloost::InterleavedAttributes::create();
+  std::vector<unsigned> candidates;
+  _graph->get_clusters_in_rect(min_x, min_y, max_x, max_y, candidates);
 
-  unsigned containerSize = numEdges * 10; // vec2 * 2 + vec3 * 2
-  std::vector<float>& container = interleavedAttributes->getVector();
-  container = std::vector<float>(containerSize, 0.0f);
+  _visible_clusters.clear();
+  _impostor_clusters.clear();
 
-  // tell the vertex attribute container which attributes are contained
-  interleavedAttributes->addAttribute(2, 8, "in_position");
-  interleavedAttributes->addAttribute(3, 12, "in_color");
-
-  unsigned vboIdx = 0;
-
-  for (unsigned i = 0; i != numEdges; ++i)
+  for (unsigned i = 0; i != candidates.size(); ++i)
   {
-    Edge* current_edge = _graph->get_edge_by_index(i);
+    unsigned i_cluster = candidates[i];
 
-    Node* source = current_edge->getSource();
-    Node* target = current_edge->getTarget();
+    if (i_cluster >= _vbo_clusters.size())
+      continue;
 
-    std::string title_source = source->_label;
-    std::string title_target = target->_label;
+    Cluster* cluster = _vbo_clusters[i_cluster];
 
-    if (!blacklist_constains(title_source) && !blacklist_constains(title_target))
-    {
-      double similarity = current_edge->getWeight();
+    // NodeSize is in clip space, half the window width is one unit
+    double radius = cluster->get_bounding_radius() + NODE_SIZE * 0.5 * _width / _scaleVector[0];
 
-      if (similarity >= _min_similarity && similarity <= _max_similarity)
-      {
-        container[vboIdx++] = source->_x; // source x
-        container[vboIdx++] = source->_y; // source y
+    // Closest point of the viewport to the cluster center
+    double x = std::max(min_x, std::min(max_x, cluster->get_position_x()));
+    double y = std::max(min_y, std::min(max_y, cluster->get_position_y()));
 
-        container[vboIdx++] = current_edge->_color[0]; // edge color r
-        container[vboIdx++] = current_edge->_color[1]; // edge color g
-        container[vboIdx++] = current_edge->_color[2]; // edge color b
+    double dx = x - cluster->get_position_x();
+    double dy = y - cluster->get_position_y();
 
-        container[vboIdx++] = target->_x; // target x
-        container[vboIdx++] = target->_y; // target y
+    if (dx * dx + dy * dy > radius * radius)
+      continue;
 
-        container[vboIdx++] = current_edge->_color[0]; // edge color r
-        container[vboIdx++] = current_edge->_color[1]; // edge color g
-        container[vboIdx++] = current_edge->_color[2]; // edge color b
-      }
+    if (_draw_impostors && cluster->get_bounding_radius() * _scaleVector[0] < LOD_PIXEL_RADIUS)
+    {
+      if (_cluster_visible_nodes[i_cluster] != 0)
+        _impostor_clusters.push_back(i_cluster);
+    }
+    else
+    {
+      _visible_clusters.push_back(i_cluster);
     }
   }
-  _vboEdges = gloost::gl::Vbo4::create(interleavedAttributes);
+
+  _num_clusters_on_screen = _visible_clusters.size() + _impostor_clusters.size();
 }
 
 
@@ -387,12 +683,25 @@ OverviewRenderer::fill_vbo_edges()
 
 /**
   \brief   Draw nodes and edges
-  \remarks ...
+  \remarks Only clusters overlapping the viewport are drawn, one draw command
+           per cluster, submitted with one multi draw call. Edge commands
+           only cover the similarity window of their cluster. Bundles are
+           drawn with a single draw over the window buckets. Impostors are
+           drawn after the nodes, one command per run of consecutive clusters,
+           the hovered node and its neighbors last. With _density_edges the
+           edges are drawn as density (DensityRenderer).
 */
 
 void
 OverviewRenderer::draw_nodes_and_edges(gloost::vec4 nodes_color, gloost::vec4 edges_color)
 {
+  FrameProfiler::CpuScope cpu_scope("draw_nodes_and_edges");
+
+  collect_visible_clusters();
+
+  _drawn_node_num = 0;
+  _drawn_edge_num = 0;
+
   // set modelview matrix
   _modelMatrixStack.clear();
   _modelMatrixStack.push();
@@ -402,42 +711,245 @@ OverviewRenderer::draw_nodes_and_edges(gloost::vec4 nodes_color, gloost::vec4 ed
 
     _uniformSet.set_mat4("Model", gloost::mat4(_modelMatrixStack.top())); // set current model view matrix
 
-    _edgeShader->use();
+    // Upload the ranges written since the last frame
+    _vboNodes.commit();
+    _vboEdges.commit();
+
+    // In density mode the edges add up their weights in the density
+    // framebuffer, which is resolved before the nodes are drawn
+    _uniformSet.set_int("DensityMode", _density_edges ? 1 : 0);
+
     {
-      _uniformSet.applyToShader(_edgeShader.get());
+      FrameProfiler::GpuScope gpu_scope("overview edges");
+
+      if (_density_edges)
+        _density.begin();
 
-//      for (unsigned i = 0; i != _cluster_edge_vbo.size(); ++i)
-//      {
-//        _cluster_edge_vbo[i]->bind();
-//        _cluster_edge_vbo[i]->draw(GL_LINES);
-//        _cluster_edge_vbo[i]->unbind();
-//      }
+      if (_edges_bundled)
+      {
+        _edgeShader->use();
+        {
+          // Similarity window, edges outside are culled in the shader
+          _uniformSet.set_float("MinSimilarity", _filter.get_minimum_similarity());
+          _uniformSet.set_float("MaxSimilarity", _filter.get_maximum_similarity());
 
-      _vboEdges->bind();
-      _vboEdges->draw(GL_LINES);
-      _vboEdges->unbind();
+          // Segments without a visible edge are culled in the shader
+          _uniformSet.set_int("Visibility", 1);
+          _uniformSet.set_int("VisibilityTest", 1);
 
+          _edge_visibility.bind(1);
+
+          _uniformSet.applyToShader(_edgeShader.get());
+
+          // Only draw the buckets inside the similarity window
+          unsigned first_edge = _edge_bucket_offsets[SimilarityIndex::get_first_bucket(_filter.get_minimum_similarity())];
+          unsigned end_edge   = _edge_bucket_offsets[SimilarityIndex::get_end_bucket(_filter.get_maximum_similarity())];
+
+          if (first_edge < end_edge)
+          {
+            _drawn_edge_num += end_edge - first_edge;
+
+            _vboEdges.bind();
+            glDrawArrays(GL_LINES, first_edge * 2, (end_edge - first_edge) * 2);
+            _vboEdges.unbind();
+            _vboEdges.fence();
+          }
+
+          _edge_visibility.unbind(1);
+        }
+        _edgeShader->disable();
+      }
+      else
+      {
+        // Similarity window of every visible cluster
+        _edge_commands.clear();
+
+        for (unsigned i = 0; i != _visible_clusters.size(); ++i)
+        {
+          unsigned i_cluster = _visible_clusters[i];
+
+          SimilarityIndex const& similarity_index = _vbo_clusters[i_cluster]->get_similarity_index();
+
+          unsigned first_edge = similarity_index.get_range_begin(_filter.get_minimum_similarity());
+          unsigned end_edge   = similarity_index.get_range_end(_filter.get_maximum_similarity());
+
+          if (first_edge < end_edge)
+          {
+            _edge_commands.add_elements((end_edge - first_edge) * 2, (_cluster_edge_offsets[i_cluster] + first_edge) * 2);
+            _drawn_edge_num += end_edge - first_edge;
+          }
+        }
+
+        if (_edge_commands.get_command_num() != 0)
+        {
+          _indexedEdgeShader->use();
+          {
+            _uniformSet.set_int("Visibility", 1);
+            _uniformSet.set_int("Weights", 2);
+            _uniformSet.set_int("VisibilityTest", 1);
+
+            _edge_visibility.bind(1);
+            _edge_indices.bind_weights(2);
+
+            _uniformSet.applyToShader(_indexedEdgeShader.get());
+
+            // Edges index the node vbo, the shader gets the first edge of
+            // every command from the command buffer
+            _vboNodes.bind();
+            _edge_indices.bind_indices();
+            _edge_commands.upload();
+            _edge_commands.bind_first_index(2);
+
+            _edge_commands.draw_elements(GL_LINES);
+
+            _edge_commands.unbind_first_index(2);
+            _vboNodes.unbind();
+
+            _edge_indices.unbind_weights(2);
+            _edge_visibility.unbind(1);
+          }
+          _indexedEdgeShader->disable();
+        }
+      }
+
+      if (_density_edges)
+      {
+        _density.end();
+        _density.resolve();
+      }
     }
-    _edgeShader->disable();
 
 
-    _nodeShader->use();
     {
-      _uniformSet.applyToShader(_nodeShader.get());
+      FrameProfiler::GpuScope gpu_scope("overview nodes");
+
+      // One quad instance per node of every visible cluster
+      _node_commands.clear();
 
-//      for (unsigned i = 0; i != _cluster_node_vbo.size(); ++i)
-//      {
-//        _cluster_node_vbo[i]->bind();
-//        _cluster_node_vbo[i]->draw(GL_POINTS);
-//        _cluster_node_vbo[i]->unbind();
-//      }
+      for (unsigned i = 0; i != _visible_clusters.size(); ++i)
+      {
+        unsigned i_cluster = _visible_clusters[i];
+
+        unsigned node_offset = _cluster_node_offsets[i_cluster];
+        unsigned node_num    = _cluster_node_offsets[i_cluster + 1] - node_offset;
+
+        if (node_num != 0)
+          _node_commands.add_arrays(4, node_num, 0, node_offset);
+
+        _drawn_node_num += node_num;
+      }
+
+      if (_node_commands.get_command_num() != 0)
+      {
+        _nodeShader->use();
+        {
+          _uniformSet.set_int("VisibilityTest", 1);
+          _node_visibility.bind(1);
+
+          _uniformSet.set_float("NodeSize", NODE_SIZE);
+
+          _uniformSet.applyToShader(_nodeShader.get());
 
-      _vboNodes->bind();
-      _vboNodes->draw(GL_POINTS);
-      _vboNodes->unbind();
+          _vboNodes.bind_instanced();
+          _node_commands.draw_arrays(GL_TRIANGLE_STRIP, _vboNodes);
+          _vboNodes.unbind();
 
+          _node_visibility.unbind(1);
+        }
+        _nodeShader->disable();
+      }
+
+      _vboNodes.fence();
+    }
+
+
+    {
+      FrameProfiler::GpuScope gpu_scope("overview impostors");
+
+      // One disc instance per small cluster
+      _impostor_commands.clear();
+
+      for (unsigned i = 0; i != _impostor_clusters.size();)
+      {
+        unsigned first_cluster = _impostor_clusters[i];
+        unsigned cluster_num = 1;
+
+        while (i + cluster_num != _impostor_clusters.size() && _impostor_clusters[i + cluster_num] == first_cluster + cluster_num)
+          ++cluster_num;
+
+        _impostor_commands.add_arrays(4, cluster_num, 0, first_cluster);
+
+        i += cluster_num;
+      }
+
+      if (_impostor_commands.get_command_num() != 0)
+      {
+        _impostorShader->use();
+        {
+          _uniformSet.set_float("NodeSize", NODE_SIZE);
+
+          _uniformSet.applyToShader(_impostorShader.get());
+
+          _vboImpostors.commit();
+          _vboImpostors.bind_instanced();
+          _impostor_commands.draw_arrays(GL_TRIANGLE_STRIP, _vboImpostors);
+          _vboImpostors.unbind();
+          _vboImpostors.fence();
+        }
+        _impostorShader->disable();
+      }
+    }
+
+
+    {
+      FrameProfiler::GpuScope gpu_scope("overview highlight");
+
+      // Hovered node with the edges to its neighbors on top
+      if (_highlight_dirty || _highlight_layout_version != _graph->get_layout_version())
+        fill_vbo_highlight();
+
+      if (_vboHighlightNodes.get_vertex_num() != 0)
+      {
+        _drawn_node_num += _vboHighlightNodes.get_vertex_num();
+        _drawn_edge_num += _vboHighlightEdges.get_vertex_num() / 2;
+
+        _vboHighlightNodes.commit();
+        _vboHighlightEdges.commit();
+
+        _uniformSet.set_int("DensityMode", 0);
+        _uniformSet.set_int("VisibilityTest", 0);
+
+        if (_vboHighlightEdges.get_vertex_num() != 0)
+        {
+          _edgeShader->use();
+          {
+            _uniformSet.set_float("MinSimilarity", _filter.get_minimum_similarity());
+            _uniformSet.set_float("MaxSimilarity", _filter.get_maximum_similarity());
+
+            _uniformSet.applyToShader(_edgeShader.get());
+
+            _vboHighlightEdges.bind();
+            glDrawArrays(GL_LINES, 0, _vboHighlightEdges.get_vertex_num());
+            _vboHighlightEdges.unbind();
+            _vboHighlightEdges.fence();
+          }
+          _edgeShader->disable();
+        }
+
+        _nodeShader->use();
+        {
+          _uniformSet.set_float("NodeSize", 2.0f * NODE_SIZE);
+
+          _uniformSet.applyToShader(_nodeShader.get());
+
+          _vboHighlightNodes.bind_instanced();
+          glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, _vboHighlightNodes.get_vertex_num());
+          _vboHighlightNodes.unbind();
+          _vboHighlightNodes.fence();
+        }
+        _nodeShader->disable();
+      }
     }
-    _nodeShader->disable();
   }
   _modelMatrixStack.pop();
 }
@@ -453,6 +965,37 @@ OverviewRenderer::draw_nodes_and_edges(gloost::vec4 nodes_color, gloost::vec4 ed
 void
 OverviewRenderer::display()
 {
+  // Apply filter changes, only visibility bits are uploaded (bundles too)
+  if (_filter.update())
+  {
+    update_visibility();
+
+    _highlight_dirty = true;
+  }
+
+  // Apply the latest positions of a running layout, only moved clusters are uploaded
+  if (_layout_worker.apply_latest())
+    _positions_dirty = true;
+
+  // Bundles wait for the final positions
+  if (_layout_running && !_layout_worker.is_running() && _bundle_edges)
+    _vbos_dirty = true;
+
+  _layout_running = _layout_worker.is_running();
+
+  if (_vbos_dirty)
+  {
+    fill_vbo_nodes();
+    fill_vbo_edges();
+  }
+  else if (_positions_dirty)
+  {
+    update_vbo_positions();
+  }
+
+  _vbos_dirty = false;
+  _positions_dirty = false;
+
   // setup clear color and clear screen
   glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -477,38 +1020,39 @@ OverviewRenderer::display()
   _mouseState.resetMouseEvents();
   _mouseState.setSpeedToZero();
 
-  //  Text:
-  //  - maximum and minimum displayed similarity
-  //  - number of edges and nodes
-  glPushMatrix();
-  glPushAttrib(GL_ALL_ATTRIB_BITS);
   {
-    glDisable(GL_DEPTH_TEST);
-    glDepthMask(GL_FALSE);
-    glEnable(GL_TEXTURE_2D);
+    FrameProfiler::CpuScope cpu_scope("overview hud");
+    FrameProfiler::GpuScope gpu_scope("overview hud");
 
-    glMatrixMode(GL_PROJECTION);
-    gloostLoadMatrix(_projectionMatrix.data());
+    //  Text:
+    //  - maximum and minimum displayed similarity
+    //  - number of edges and nodes
+    _text.clear();
+    _text.add_text(10.0f, _height - 20.0f, "Maximum similarity: " + boost::lexical_cast<std::string>(_filter.get_maximum_similarity()));
+    _text.add_text(10.0f, _height - 35.0f, "Minimum similarity: " + boost::lexical_cast<std::string>(_filter.get_minimum_similarity()));
 
-    glMatrixMode(GL_MODELVIEW);
-    gloostLoadMatrix(_viewMatrix.data());
+    _text.add_text(10.0f, _height - 50.0f, "Number of nodes: " + boost::lexical_cast<std::string>(_graph->get_node_num()));
+    _text.add_text(10.0f, _height - 65.0f, "Number of edges: " + boost::lexical_cast<std::string>(_graph->get_edge_num()));
 
-    _typeWriter->beginText();
-    {
-      glColor4f(0.0f, 1.0f, 0.0f, 1.0f);
-      _typeWriter->writeLine(10.0, _height - 20.0, "Maximum similarity: " + boost::lexical_cast<std::string>(_max_similarity));
-      _typeWriter->nextLine();
-      _typeWriter->writeLine(10.0, _height - 30.0, "Minimum similarity: " + boost::lexical_cast<std::string>(_min_similarity));
-
-      _typeWriter->nextLine();
-      _typeWriter->writeLine(10.0, _height - 40.0, "Number of nodes: " + boost::lexical_cast<std::string>(_graph->get_node_num()));
-      _typeWriter->nextLine();
-      _typeWriter->writeLine(10.0, _height - 50.0, "Number of edges: " + boost::lexical_cast<std::string>(_graph->get_edge_num()));
-    }
-    _typeWriter->endText();
+    if (_layout_worker.is_running())
+      _text.add_text(10.0f, _height - 80.0f, "Layout: " + boost::lexical_cast<std::string>((int) (_layout_worker.get_progress() * 100.0f)) + "%");
+
+    _text.draw(_projectionMatrix, _viewMatrix);
   }
-  glPopAttrib();
-  glPopMatrix();
+}
+
+
+unsigned
+OverviewRenderer::get_drawn_node_num() const
+{
+  return _drawn_node_num;
+}
+
+
+unsigned
+OverviewRenderer::get_drawn_edge_num() const
+{
+  return _drawn_edge_num;
 }
 
 
@@ -561,17 +1105,143 @@ OverviewRenderer::get_cluster_index_from_mouse_pos(gloost::Vector3& mouse_positi
 
     _modelMatrixStack.pop();
 
-    double cluster_size = _graph->get_cluster_size();
-    unsigned clusters_per_row = _graph->get_clusters_per_row_num();
-
-    idx = floor( mouse_position[0] / cluster_size ) +
-         (floor( mouse_position[1] / cluster_size ) * clusters_per_row);
+    idx = _graph->get_cluster_index_at(mouse_position[0], mouse_position[1]);
   }
 
   return idx;
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Finds the node under the mouse position
+  \remarks Nearest node of the cluster under the mouse within the node quad
+           size (at least PICK_PIXEL_RADIUS pixels), hidden nodes are skipped
+           by widening the search to all nodes in the radius
+*/
+
+bool
+OverviewRenderer::get_node_from_mouse_pos(gloost::Vector3 mouse_position, unsigned& i_cluster, unsigned& i_node)
+{
+  i_cluster = get_cluster_index_from_mouse_pos(mouse_position);
+
+  if (i_cluster >= _vbo_clusters.size() || _vbo_clusters[i_cluster] != _graph->get_cluster_by_index(i_cluster))
+    return false;
+
+  // NodeSize is in clip space, half the window width is one unit
+  double radius = std::max(NODE_SIZE * 0.5 * _width, PICK_PIXEL_RADIUS) / _scaleVector[0];
+
+  NodeGrid const& grid = get_node_grid(i_cluster);
+  Cluster* cluster = _vbo_clusters[i_cluster];
+
+  i_node = grid.find_nearest(mouse_position[0], mouse_position[1], radius);
+
+  if (i_node == cluster->get_node_num())
+    return false;
+
+  if (_filter.is_node_visible(cluster->get_node(i_node)->_id))
+    return true;
+
+  // Nearest visible node
+  std::vector<unsigned> candidates;
+  grid.find_in_radius(mouse_position[0], mouse_position[1], radius, candidates);
+
+  double best = radius * radius;
+  i_node = cluster->get_node_num();
+
+  for (unsigned i = 0; i != candidates.size(); ++i)
+  {
+    Node* current_node = cluster->get_node(candidates[i]);
+
+    double dx = current_node->_x - mouse_position[0];
+    double dy = current_node->_y - mouse_position[1];
+
+    if (dx * dx + dy * dy <= best && _filter.is_node_visible(current_node->_id))
+    {
+      best = dx * dx + dy * dy;
+      i_node = candidates[i];
+    }
+  }
+
+  return i_node != cluster->get_node_num();
+}
+
+
+NodeGrid const&
+OverviewRenderer::get_node_grid(unsigned i_cluster)
+{
+  NodeGrid& grid = _node_grids[i_cluster];
+
+  if (grid.get_cluster() != _vbo_clusters[i_cluster] || _node_grid_versions[i_cluster] != _graph->get_layout_version())
+  {
+    grid.build(_vbo_clusters[i_cluster]);
+    _node_grid_versions[i_cluster] = _graph->get_layout_version();
+  }
+
+  return grid;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Fills the highlight vbos
+  \remarks The hovered node and its neighbors over the visible edges, read
+           from the edge lists of the node. Edges outside the similarity
+           window are culled by the edge shader, so the vbos do not depend on
+           the window. Empty if the hovered node is hidden.
+*/
+
+void
+OverviewRenderer::fill_vbo_highlight()
+{
+  _highlight_dirty = false;
+  _highlight_layout_version = _graph->get_layout_version();
+
+  Node* hovered = nullptr;
+
+  if (_hovering && _hover_cluster < _vbo_clusters.size())
+    hovered = _vbo_clusters[_hover_cluster]->get_node(_hover_node);
+
+  if (!hovered || !_filter.is_node_visible(hovered->_id))
+  {
+    _vboHighlightNodes.resize(0);
+    _vboHighlightEdges.resize(0);
+    return;
+  }
+
+  std::vector<float> nodes = { (float) hovered->_x, (float) hovered->_y, 1.0f, 1.0f, 1.0f };
+  std::vector<float> edges;
+
+  std::vector<Edge*> node_edges(hovered->outgoingEdges);
+  node_edges.insert(node_edges.end(), hovered->incomingEdges.begin(), hovered->incomingEdges.end());
+
+  for (unsigned i = 0; i != node_edges.size(); ++i)
+  {
+    Edge* edge = node_edges[i];
+    Node* neighbor = edge->getSource() == hovered ? edge->getTarget() : edge->getSource();
+    float weight = edge->getWeight();
+
+    if (!_filter.is_edge_visible(edge->getIndex()) || !_filter.is_node_visible(neighbor->_id))
+      continue;
+
+    float const neighbor_vertex[] = { (float) neighbor->_x, (float) neighbor->_y, 1.0f, 1.0f, 0.0f };
+    nodes.insert(nodes.end(), neighbor_vertex, neighbor_vertex + 5);
+
+    float const edge_vertices[] = { (float) hovered->_x,  (float) hovered->_y,  1.0f, 1.0f, 0.0f, weight,
+                                    (float) neighbor->_x, (float) neighbor->_y, 1.0f, 1.0f, 0.0f, weight };
+    edges.insert(edges.end(), edge_vertices, edge_vertices + 12);
+  }
+
+  _vboHighlightNodes.resize(nodes.size() / 5);
+  _vboHighlightNodes.write(0, nodes);
+
+  _vboHighlightEdges.resize(edges.size() / 6);
+  _vboHighlightEdges.write(0, edges);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -599,24 +1269,12 @@ OverviewRenderer::mousePress(int x, int y, int btn, int mods)
     {
       _graph->_detail_view_cluster_index = cluster_idx;
 
-      Cluster* clicked_cluster = _graph->get_cluster_by_index(cluster_idx);
-
-
-        /// Get infos about clicked node
-//      double node_size = 15000.0;
-//      for (unsigned i = 0; i != clicked_cluster->get_node_num(); ++i)
-//      {
-//        Node* current_node = clicked_cluster->get_node(i);
-//
-//        // Check if mouse is over this node
-//        if (mouse_position[0] >= current_node->_x - node_size && mouse_position[0] <= current_node->_x + node_size &&
-//            mouse_position[1] >= current_node->_y - node_size && mouse_position[1] <= current_node->_y + node_size)
-//            {
-//
-////              std::vector<uint32_t> parents = current_node->_article.getParents();
-//              current_node->_article.info();
-//            }
-//      }
+      /// Get infos about clicked node
+      unsigned i_cluster = 0;
+      unsigned i_node = 0;
+
+      if (get_node_from_mouse_pos(_mouseState.getPosition(), i_cluster, i_node))
+        _vbo_clusters[i_cluster]->get_node(i_node)->_article.info();
     }
   }
 }
@@ -664,57 +1322,23 @@ OverviewRenderer::mouseMove(int x, int y)
   }
 
 
-//  /// Mouse over node functions
-//  if (_highlight_at_mouse_over)
-//  {
-//    _highlighted_nodes.clear();
-//    _highlighted_edges.clear();
-//
-//    double node_size = 15000.0;
-//
-//    gloost::Vector3 mouse_position = _mouseState.getPosition();
-//
-//    unsigned cluster_idx = get_cluster_index_from_mouse_pos(mouse_position);
-//
-//    // mouse pos is inside graph bounding
-//    if (cluster_idx < _graph->get_cluster_num())
-//    {
-//      Cluster* cluster_mouse_inside = _graph->get_cluster_by_index(cluster_idx);
-//
-//      // For all nodes of this cluster
-//      for (unsigned i = 0; i != cluster_mouse_inside->get_node_num(); ++i)
-//      {
-//        Node* current_node = cluster_mouse_inside->get_node(i);
-//
-//        // Check if mouse is over this node
-//        if (mouse_position[0] >= current_node->_x - node_size && mouse_position[0] <= current_node->_x + node_size &&
-//            mouse_position[1] >= current_node->_y - node_size && mouse_position[1] <= current_node->_y + node_size)
-//        {
-//          _highlighted_nodes.push_back(current_node);
-//
-//          // For all outgoing edges
-//          for (unsigned i = 0; i != current_node->outgoingEdges.size(); i++)
-//          {
-//            Node* neighboor_node = current_node->outgoingEdges[i]->getTarget();
-//
-//            // Push back all outgoing edges and their target nodes
-//            _highlighted_edges.push_back(current_node->outgoingEdges[i]);
-//            _highlighted_nodes.push_back(neighboor_node);
-//          }
-//
-//          // For all incoming edges
-//          for (unsigned i = 0; i != current_node->incomingEdges.size(); i++)
-//          {
-//            Node* neighboor_node = current_node->incomingEdges[i]->getSource();
-//
-//            // Push back all incoming edges and their source-nodes
-//            _highlighted_edges.push_back(current_node->incomingEdges[i]);
-//            _highlighted_nodes.push_back(neighboor_node);
-//          }
-//        }
-//      }
-//    }
-//  }
+  /// Mouse over node functions
+  if (_highlight_at_mouse_over)
+  {
+    unsigned i_cluster = 0;
+    unsigned i_node = 0;
+
+    bool hovering = get_node_from_mouse_pos(_mouseState.getPosition(), i_cluster, i_node);
+
+    if (hovering != _hovering || (hovering && (i_cluster != _hover_cluster || i_node != _hover_node)))
+    {
+      _hovering = hovering;
+      _hover_cluster = i_cluster;
+      _hover_node = i_node;
+
+      _highlight_dirty = true;
+    }
+  }
 }
 
 
@@ -743,6 +1367,24 @@ OverviewRenderer::mouseScrollDecrease()
 }
 
 
+void
+OverviewRenderer::set_view(double scale, double translate_x, double translate_y)
+{
+  _scaleVector[0] = scale;
+  _scaleVector[1] = scale;
+
+  _translateVector[0] = translate_x;
+  _translateVector[1] = translate_y;
+}
+
+
+double
+OverviewRenderer::get_scale() const
+{
+  return _scaleVector[0];
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -769,7 +1411,11 @@ OverviewRenderer::keyPress(int key, int mods)
 
       // Reload shaders
       _edgeShader->reloadShaders();
+      _indexedEdgeShader->reloadShaders();
       _nodeShader->reloadShaders();
+      _impostorShader->reloadShaders();
+      _density.reload_shaders();
+      _text.reload_shaders();
 
       std::cout << "Reload shaders" << std::endl;
 
@@ -780,13 +1426,8 @@ OverviewRenderer::keyPress(int key, int mods)
     {
       std::cout << "Change layout to radial" << std::endl;
 
-      // Change layout for every cluster
-      for (unsigned i = 0; i != _graph->get_cluster_num(); ++i)
-        _graph->get_cluster_by_index(i)->make_radial_layout();
-
-      // Fill vbos with new positions
-      fill_vbo_nodes();
-      fill_vbo_edges();
+      // Change layout for every cluster, positions are applied in display()
+      _layout_worker.start(Visualization::RADIAL_LAYOUT);
 
       break;
     }
@@ -795,9 +1436,53 @@ OverviewRenderer::keyPress(int key, int mods)
     {
       std::cout << "Change layout to ring" << std::endl;
 
-      // Change layout for every cluster
-      for (unsigned i = 0; i != _graph->get_cluster_num(); ++i)
-        _graph->get_cluster_by_index(i)->make_ring_layout();
+      // Change layout for every cluster, positions are applied in display()
+      _layout_worker.start(Visualization::RING_LAYOUT);
+
+      break;
+    }
+
+    case 51: // 3
+    {
+      std::cout << "Change layout to force directed" << std::endl;
+
+      // Change layout for every cluster, positions are applied in display()
+      _layout_worker.start(Visualization::FORCE_LAYOUT);
+
+      break;
+    }
+
+    case 52: // 4
+    {
+      std::cout << "Change layout to multilevel force directed" << std::endl;
+
+      // Change layout for every cluster, positions are applied in display()
+      _layout_worker.start(Visualization::MULTILEVEL_LAYOUT);
+
+      break;
+    }
+
+    case 53: // 5
+    {
+      std::cout << "Change layout to pivot MDS" << std::endl;
+
+      // Change layout for every cluster, positions are applied in display()
+      _layout_worker.start(Visualization::PIVOT_MDS_LAYOUT);
+
+      break;
+    }
+
+    case 80: // P
+    {
+      // Toggle between uniform grid and shelf packing
+      if (_graph->get_cluster_packing() == Visualization::GRID_PACKING)
+        _graph->set_cluster_packing(Visualization::SHELF_PACKING);
+      else
+        _graph->set_cluster_packing(Visualization::GRID_PACKING);
+
+      _graph->set_cluster_positions();
+
+      std::cout << "Toggle cluster packing to: " << _graph->get_cluster_packing() << std::endl;
 
       // Fill vbos with new positions
       fill_vbo_nodes();
@@ -806,29 +1491,63 @@ OverviewRenderer::keyPress(int key, int mods)
       break;
     }
 
+    case 66: // B
+    {
+      _bundle_edges = !_bundle_edges;
+
+      std::cout << "Toggle edge bundling to: " << _bundle_edges << std::endl;
+
+      fill_vbo_edges();
+
+      break;
+    }
+
     case 72: // H
     {
       _highlight_at_mouse_over = !_highlight_at_mouse_over;
 
+      _hovering = false;
+      _highlight_dirty = true;
+
       std::cout << "Toggle highlight mode to: " << _highlight_at_mouse_over << std::endl;
 
       break;
     }
 
-    case 73: // I
+    case 68: // D
+    {
+      _density_edges = !_density_edges;
+
+      std::cout << "Toggle edge density to: " << _density_edges << std::endl;
+
+      break;
+    }
+
+    case 71: // G
     {
-      // Compute the number of clusters on screen
-      unsigned per_row = _graph->get_clusters_per_row_num();
-      double c_size = _graph->get_cluster_size();
+      // Next gradient of the edge density
+      _gradient_index = (_gradient_index + 1) % GRADIENT_NUM;
+
+      _density.load_gradient(GRADIENT_PATH + GRADIENTS[_gradient_index]);
 
-      c_size = c_size * _scaleVector[0];
+      std::cout << "Edge density gradient: " << GRADIENTS[_gradient_index] << std::endl;
 
-      unsigned one_row_on_screen = ceil(_width / c_size);
-      unsigned one_column_on_screen = ceil(_height / c_size);
+      break;
+    }
+
+    case 76: // L
+    {
+      _draw_impostors = !_draw_impostors;
+
+      std::cout << "Toggle cluster impostors to: " << _draw_impostors << std::endl;
 
-      unsigned clusters_on_screen = one_row_on_screen * one_column_on_screen;
+      break;
+    }
 
-      std::cout << "Anzahl cluster on screen: " << clusters_on_screen << std::endl;
+    case 73: // I
+    {
+      // Number of clusters drawn in the last frame
+      std::cout << "Anzahl cluster on screen: " << _num_clusters_on_screen << std::endl;
 
       break;
     }
@@ -867,14 +1586,14 @@ OverviewRenderer::keyRelease(int key, int mods)
 void
 OverviewRenderer::set_minimum_similarity(double sim)
 {
-  _min_similarity = sim;
+  _filter.set_minimum_similarity(sim);
 }
 
 
 void
 OverviewRenderer::set_maximum_similarity(double sim)
 {
-  _max_similarity = sim;
+  _filter.set_maximum_similarity(sim);
 }
 
 
@@ -883,19 +1602,19 @@ OverviewRenderer::set_maximum_similarity(double sim)
 /**
   \brief   Add string to blacklist to filter article titles
   \param   title
-  \remarks ...
+  \remarks Updates the node visibility, it is uploaded in display()
 */
 
 void
 OverviewRenderer::add_to_blacklist(std::string const title)
 {
-  if(std::find(_blacklist.begin(), _blacklist.end(), title) != _blacklist.end())
+  if(!_blacklist.add(title))
   {
     std::cout << title << " is allready in blacklist" << std::endl;
   }
   else
   {
-    _blacklist.push_back(title);
+    _filter.set_node_bitmap("blacklist", Bitmap::from_words(_blacklist.get_visibility(), _graph->get_node_num()));
   }
 }
 
@@ -903,23 +1622,28 @@ OverviewRenderer::add_to_blacklist(std::string const title)
 bool
 OverviewRenderer::blacklist_constains(std::string const title)
 {
-	for (unsigned i = 0; i != _blacklist.size(); i++)
-  {
-    std::size_t found = title.find(_blacklist[i]);
-    if (found!=std::string::npos)
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return _blacklist.contains(title);
 }
 
 
 std::vector<std::string>
 OverviewRenderer::get_blacklist()
 {
-  return _blacklist;
+  return _blacklist.get_entries();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Returns the filter engine
+  \remarks Changes are applied with the next display()
+*/
+
+FilterEngine*
+OverviewRenderer::get_filter()
+{
+  return &_filter;
 }
 
 
@@ -8,7 +8,6 @@
 #include <gloost/gl/Vbo4.h>
 
 #include <gloost/TextureManager.h>
-#include <gloost/FreeTypeWriter.h>
 #include <gloost/Matrix.h>
 #include <gloost/MatrixStack.h>
 
@@ -24,6 +23,21 @@
 
 // Graph
 #include <cluster/Visualization.hpp>
+#include <cluster/NodeGrid.hpp>
+
+// Filter
+#include <filter/Blacklist.hpp>
+#include <filter/FilterEngine.hpp>
+
+// Layout
+#include <layout/LayoutWorker.hpp>
+#include <layout/EdgeBundles.hpp>
+#include <renderer/DensityRenderer.hpp>
+#include <renderer/DrawCommandBuffer.hpp>
+#include <renderer/EdgeIndexBuffer.hpp>
+#include <renderer/TextRenderer.hpp>
+#include <renderer/VertexBuffer.hpp>
+#include <renderer/VisibilityBuffer.hpp>
 
 
 namespace vta
@@ -45,26 +59,49 @@ class OverviewRenderer
     // initialize
     bool initialize();
 
-    // Create a new vbo for a cluster
-    void create_cluster_node_vbo(Cluster*);
-    void create_cluster_edge_vbo(Cluster*);
-
     // Fill vbo's with nodes and edges
     void fill_vbo_nodes();
     void fill_vbo_edges();
 
+    // Fill the edge vbo with bundled edge segments
+    void fill_vbo_bundles();
+
+    // Rewrite the vbo ranges of clusters that moved
+    void update_vbo_positions();
+
+    // Upload the visibility of nodes and edges after a filter change
+    void update_visibility();
+    void update_node_visibility();
+    void update_edge_visibility();
+
+    // Clusters of the vbos that overlap the viewport, small ones as impostors
+    void collect_visible_clusters();
+
     // Draw nodes and edges (node-color, edge-color)
     void draw_nodes_and_edges(gloost::vec4, gloost::vec4);
 
     // display loop
     void display();
 
+    // Node and edge instances drawn by the last display() (without impostors)
+    unsigned get_drawn_node_num() const;
+    unsigned get_drawn_edge_num() const;
+
     // resize window
     void resize(int width, int height);
 
     // Get Cluster index from mouse position
     unsigned get_cluster_index_from_mouse_pos(gloost::Vector3&);
 
+    // Node under the mouse position (cluster index, node index in the cluster)
+    bool get_node_from_mouse_pos(gloost::Vector3, unsigned&, unsigned&);
+
+    // Spatial index of a cluster (vbo order), rebuilt after layout changes
+    NodeGrid const& get_node_grid(unsigned);
+
+    // Fill the highlight vbos with the hovered node and its neighbors
+    void fill_vbo_highlight();
+
     // mouse input
     void mousePress(int x, int y, int btn, int mods);
     void mouseRelease(int x, int y, int btn, int mods);
@@ -72,6 +109,10 @@ class OverviewRenderer
     void mouseScrollEnhance();
     void mouseScrollDecrease();
 
+    // View for screen = world * scale + translation (scale, translation x, y)
+    void set_view(double, double, double);
+    double get_scale() const;
+
     // key input
     void keyPress(int key, int mods);
     void keyRelease(int key, int mods);
@@ -85,6 +126,9 @@ class OverviewRenderer
     bool blacklist_constains(std::string const);
     std::vector<std::string> get_blacklist();
 
+    // Node and edge filters, shared with the detail view
+    FilterEngine* get_filter();
+
 
   protected:
 
@@ -107,35 +151,112 @@ class OverviewRenderer
     // data
     Visualization* _graph;
 
-    // Similarity thresholds
-    double _max_similarity;
-    double _min_similarity;
+    // Blacklist and node visibility
+    Blacklist _blacklist;
 
-    // Blacklist
-    std::vector<std::string> _blacklist;
+    // Filters (blacklist, similarity window, ...)
+    FilterEngine _filter;
+
+    // Vbos have to be refilled before the next frame
+    bool _vbos_dirty;
+
+    // Nodes moved, the ranges of moved clusters have to be rewritten
+    bool _positions_dirty;
+
+    // Layouts started by key press run in the background
+    LayoutWorker _layout_worker;
+    bool _layout_running;
+
+    // Edges are drawn bundled (built when no layout is running, of all
+    // edges, filters hide segments through _edge_visibility)
+    EdgeBundles _edge_bundles;
+    bool _bundle_edges;
+
+    // Clusters in vbo order, first node of every cluster and vertex of every node (by id)
+    std::vector<Cluster*> _vbo_clusters;
+    std::vector<unsigned> _cluster_node_offsets;
+    std::vector<unsigned> _node_slots;
+
+    // First segment of every similarity bucket inside _vboEdges (bundles)
+    std::vector<unsigned> _edge_bucket_offsets;
+
+    // Bundle segments in _vboEdges are drawn instead of _edge_indices
+    bool _edges_bundled;
+
+    // First edge of every cluster inside _edge_indices
+    std::vector<unsigned> _cluster_edge_offsets;
+
+    // Edges as node index pairs, per cluster in similarity order
+    EdgeIndexBuffer _edge_indices;
+
+    // Clusters (vbo order) overlapping the viewport and their draw commands
+    std::vector<unsigned> _visible_clusters;
+    DrawCommandBuffer _node_commands;
+    DrawCommandBuffer _edge_commands;
+
+    // Clusters smaller than LOD_PIXEL_RADIUS on screen are drawn as one disc
+    bool _draw_impostors;
+    std::vector<unsigned> _impostor_clusters;
+    DrawCommandBuffer _impostor_commands;
+
+    // Visible nodes of every cluster, clusters without any get no impostor
+    std::vector<unsigned> _cluster_visible_nodes;
+
+    // Edges are drawn as density through one of GRADIENTS
+    DensityRenderer _density;
+    bool _density_edges;
+    unsigned _gradient_index;
+
+    // Visibility bits of nodes and edges in vbo order
+    VisibilityBuffer _node_visibility;
+    VisibilityBuffer _edge_visibility;
+    std::vector<uint64_t> _node_slot_words;
+    std::vector<uint64_t> _edge_slot_words;
 
     // gl ressources
     gloost::gl::UniformSet _uniformSet;
     std::shared_ptr<gloost::gl::ShaderProgram> _edgeShader;
+    std::shared_ptr<gloost::gl::ShaderProgram> _indexedEdgeShader;
     std::shared_ptr<gloost::gl::ShaderProgram> _nodeShader;
+    std::shared_ptr<gloost::gl::ShaderProgram> _impostorShader;
 
-    // vbo for all nodes and edges
-    std::shared_ptr<gloost::gl::Vbo4> _vboNodes;
-    std::shared_ptr<gloost::gl::Vbo4> _vboEdges;
+    // vbo for all nodes, for bundle segments and for one impostor per
+    // cluster, updated in ranges
+    VertexBuffer _vboNodes;
+    VertexBuffer _vboEdges;
+    VertexBuffer _vboImpostors;
 
-    // typewriter for text rendering
-    std::shared_ptr<gloost::FreeTypeWriter> _typeWriter;
+    // text of the overlay, drawn in one call
+    TextRenderer _text;
 
     // Toggle if nodes should be highlighted at mouse over
     bool _highlight_at_mouse_over;
 
-    // Vector with all cluster vbos
-    std::vector < std::shared_ptr<gloost::gl::Vbo4> > _cluster_node_vbo;
-    std::vector < std::shared_ptr<gloost::gl::Vbo4> > _cluster_edge_vbo;
+    // Node grids of the clusters (vbo order), built on first use, and the
+    // layout version they were built for
+    std::vector<NodeGrid> _node_grids;
+    std::vector<unsigned> _node_grid_versions;
+
+    // Hovered node
+    bool _hovering;
+    unsigned _hover_cluster;
+    unsigned _hover_node;
+
+    // Highlight vbos have to be refilled (hover, layout or filter changed)
+    bool _highlight_dirty;
+    unsigned _highlight_layout_version;
+
+    // Hovered node and neighbors as node instances, edges to the neighbors
+    VertexBuffer _vboHighlightNodes;
+    VertexBuffer _vboHighlightEdges;
 
     // Number of clusters on screen
     unsigned _num_clusters_on_screen;
 
+    // Nodes and edges of the last frame
+    unsigned _drawn_node_num;
+    unsigned _drawn_edge_num;
+
 };
 
 
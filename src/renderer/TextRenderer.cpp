@@ -0,0 +1,459 @@
+#include "TextRenderer.hpp"
+
+// freetype
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+// cpp
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <cmath>
+
+
+namespace vta
+{
+
+struct TextRenderer::Atlas
+{
+  // Glyph quad in pixels relative to the pen position on the baseline
+  struct Glyph
+  {
+    bool loaded;
+    float u0;
+    float v0;
+    float u1;
+    float v1;
+    float left;
+    float top;
+    float width;
+    float height;
+    float advance;
+  };
+
+  // Latin-1
+  static const unsigned GLYPH_NUM = 256;
+
+  unsigned width;
+  unsigned height;
+  std::vector<unsigned char> pixels;
+
+  Glyph glyphs[GLYPH_NUM];
+  float line_height;
+};
+
+
+namespace
+{
+  // Width of the atlas texture in pixels
+  const unsigned ATLAS_WIDTH = 512;
+
+  // Empty pixels around every glyph, linear filtering does not reach the
+  // neighbors
+  const unsigned GLYPH_PADDING = 1;
+
+
+  // Next code point of UTF-8 text, '?' for invalid sequences
+  unsigned next_code_point(std::string const& text, unsigned& i)
+  {
+    unsigned char lead = text[i++];
+
+    if (lead < 0x80)
+      return lead;
+
+    unsigned length = (lead >= 0xF0) ? 3 : (lead >= 0xE0) ? 2 : (lead >= 0xC0) ? 1 : 0;
+
+    if (length == 0)
+      return '?';
+
+    unsigned code_point = lead & (0x3F >> length);
+
+    for (unsigned j = 0; j != length; ++j)
+    {
+      if (i == text.size() || (text[i] & 0xC0) != 0x80)
+        return '?';
+
+      code_point = (code_point << 6) | (text[i++] & 0x3F);
+    }
+
+    return code_point;
+  }
+}
+
+
+TextRenderer::TextRenderer()
+ : _atlas(nullptr),
+   _texture(0),
+   _glyphs(),
+   _vboGlyphs(),
+   _uniformSet(),
+   _textShader(nullptr)
+{
+  std::fill(_color, _color + 4, 1.0f);
+}
+
+
+TextRenderer::~TextRenderer()
+{
+  if (_texture)
+    glDeleteTextures(1, &_texture);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Loads the font and creates the atlas texture
+  \remarks Needs a gl context, the texture belongs to it
+*/
+
+bool
+TextRenderer::initialize(std::string const& font_path, float pixel_size)
+{
+  _atlas = load_atlas(font_path, pixel_size);
+
+  if (!_atlas)
+    return false;
+
+  // create shader program and attach all components
+  _textShader = gloost::gl::ShaderProgram::create();
+  _textShader->attachShader(GLOOST_SHADERPROGRAM_VERTEX_SHADER,   "../../shaders/text.vs");
+  _textShader->attachShader(GLOOST_SHADERPROGRAM_FRAGMENT_SHADER, "../../shaders/text.fs");
+
+  if (!_texture)
+    glGenTextures(1, &_texture);
+
+  glBindTexture(GL_TEXTURE_2D, _texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, _atlas->width, _atlas->height, 0, GL_RED, GL_UNSIGNED_BYTE, &_atlas->pixels[0]);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  // in_rect, in_tex_rect, in_color
+  _vboGlyphs.set_format(std::vector<unsigned>{4, 4, 4});
+
+  _uniformSet.set_int("Atlas", 0);
+
+  return true;
+}
+
+
+void
+TextRenderer::reload_shaders()
+{
+  if (_textShader)
+    _textShader->reloadShaders();
+}
+
+
+void
+TextRenderer::set_color(float r, float g, float b, float a)
+{
+  _color[0] = r;
+  _color[1] = g;
+  _color[2] = b;
+  _color[3] = a;
+}
+
+
+void
+TextRenderer::clear()
+{
+  _glyphs.clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Appends the glyph quads of a line
+  \remarks The pen starts at a whole pixel, unscaled glyphs map texels to
+           pixels
+*/
+
+float
+TextRenderer::add_text(float x, float y, std::string const& text, float scale)
+{
+  if (!_atlas)
+    return 0.0f;
+
+  float pen_x = floor(x + 0.5f);
+  float pen_y = floor(y + 0.5f);
+
+  for (unsigned i = 0; i != text.size(); )
+  {
+    unsigned code_point = next_code_point(text, i);
+
+    if (code_point >= Atlas::GLYPH_NUM || !_atlas->glyphs[code_point].loaded)
+      code_point = '?';
+
+    Atlas::Glyph const& glyph = _atlas->glyphs[code_point];
+
+    if (glyph.width != 0.0f && glyph.height != 0.0f)
+    {
+      float x0 = pen_x + glyph.left * scale;
+      float y1 = pen_y + glyph.top * scale;
+
+      float const quad[] = { x0, y1 - glyph.height * scale, x0 + glyph.width * scale, y1,
+                             glyph.u0, glyph.v0, glyph.u1, glyph.v1,
+                             _color[0], _color[1], _color[2], _color[3] };
+
+      _glyphs.insert(_glyphs.end(), quad, quad + 12);
+    }
+
+    pen_x += glyph.advance * scale;
+  }
+
+  return pen_x - floor(x + 0.5f);
+}
+
+
+float
+TextRenderer::get_text_width(std::string const& text, float scale) const
+{
+  if (!_atlas)
+    return 0.0f;
+
+  float width = 0.0f;
+
+  for (unsigned i = 0; i != text.size(); )
+  {
+    unsigned code_point = next_code_point(text, i);
+
+    if (code_point >= Atlas::GLYPH_NUM || !_atlas->glyphs[code_point].loaded)
+      code_point = '?';
+
+    width += _atlas->glyphs[code_point].advance * scale;
+  }
+
+  return width;
+}
+
+
+float
+TextRenderer::get_line_height(float scale) const
+{
+  return _atlas ? _atlas->line_height * scale : 0.0f;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Draws all glyphs with one instanced draw call
+  \remarks Blends over the framebuffer without depth test, the blend and
+           depth state is restored
+*/
+
+void
+TextRenderer::draw(gloost::Matrix const& projection, gloost::Matrix const& view)
+{
+  if (!_atlas || _glyphs.empty())
+    return;
+
+  unsigned glyph_num = _glyphs.size() / 12;
+
+  // Same text as last frame uploads nothing
+  if (_vboGlyphs.get_vertex_num() != glyph_num)
+  {
+    _vboGlyphs.resize(glyph_num);
+    _vboGlyphs.write(0, _glyphs);
+  }
+  else
+  {
+    _vboGlyphs.update(0, _glyphs);
+  }
+
+  _vboGlyphs.commit();
+
+  GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+  GLboolean blend_enabled = glIsEnabled(GL_BLEND);
+  GLint blend_src;
+  GLint blend_dst;
+  glGetIntegerv(GL_BLEND_SRC_RGB, &blend_src);
+  glGetIntegerv(GL_BLEND_DST_RGB, &blend_dst);
+
+  glDisable(GL_DEPTH_TEST);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  _textShader->use();
+  {
+    _uniformSet.set_mat4("Projection", gloost::mat4(projection));
+    _uniformSet.set_mat4("View", gloost::mat4(view));
+
+    _uniformSet.applyToShader(_textShader.get());
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _texture);
+
+    // One quad instance per glyph
+    _vboGlyphs.bind_instanced();
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, glyph_num);
+    _vboGlyphs.unbind();
+    _vboGlyphs.fence();
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+  _textShader->disable();
+
+  glBlendFunc(blend_src, blend_dst);
+
+  if (!blend_enabled)
+    glDisable(GL_BLEND);
+
+  if (depth_test)
+    glEnable(GL_DEPTH_TEST);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Rasterizes the Latin-1 glyphs of a font into an atlas
+  \remarks Glyphs are packed in rows of ATLAS_WIDTH pixels, the height is the
+           next power of two. Atlases are cached by font and size, nullptr if
+           the font can not be loaded.
+*/
+
+/*static*/
+std::shared_ptr<TextRenderer::Atlas const>
+TextRenderer::load_atlas(std::string const& font_path, float pixel_size)
+{
+  static std::map<std::string, std::shared_ptr<Atlas const> > atlases;
+
+  std::ostringstream key;
+  key << font_path << ':' << pixel_size;
+
+  std::map<std::string, std::shared_ptr<Atlas const> >::const_iterator cached = atlases.find(key.str());
+
+  if (cached != atlases.end())
+    return cached->second;
+
+  FT_Library library;
+
+  if (FT_Init_FreeType(&library))
+  {
+    std::cerr << "Could not initialize FreeType" << std::endl;
+    return nullptr;
+  }
+
+  FT_Face face;
+
+  if (FT_New_Face(library, font_path.c_str(), 0, &face))
+  {
+    std::cerr << "Could not load font: " << font_path << std::endl;
+    FT_Done_FreeType(library);
+    return nullptr;
+  }
+
+  FT_Set_Pixel_Sizes(face, 0, (FT_UInt) (pixel_size + 0.5f));
+
+  std::shared_ptr<Atlas> atlas = std::make_shared<Atlas>();
+  atlas->width = ATLAS_WIDTH;
+  atlas->line_height = face->size->metrics.height / 64.0f;
+
+  // Bitmaps and their positions in the atlas
+  std::vector<std::vector<unsigned char> > bitmaps(Atlas::GLYPH_NUM);
+  std::vector<unsigned> glyph_x(Atlas::GLYPH_NUM, 0);
+  std::vector<unsigned> glyph_y(Atlas::GLYPH_NUM, 0);
+
+  unsigned row_x = GLYPH_PADDING;
+  unsigned row_y = GLYPH_PADDING;
+  unsigned row_height = 0;
+
+  for (unsigned code_point = 0; code_point != Atlas::GLYPH_NUM; ++code_point)
+  {
+    Atlas::Glyph& glyph = atlas->glyphs[code_point];
+    glyph = Atlas::Glyph();
+
+    // Control characters
+    if (code_point < 32 || (code_point >= 127 && code_point < 160))
+      continue;
+
+    if (FT_Load_Char(face, code_point, FT_LOAD_RENDER))
+      continue;
+
+    FT_GlyphSlot slot = face->glyph;
+
+    glyph.loaded = true;
+    glyph.left = slot->bitmap_left;
+    glyph.top = slot->bitmap_top;
+    glyph.width = slot->bitmap.width;
+    glyph.height = slot->bitmap.rows;
+    glyph.advance = slot->advance.x / 64.0f;
+
+    unsigned width = slot->bitmap.width;
+    unsigned height = slot->bitmap.rows;
+
+    if (width == 0 || height == 0)
+      continue;
+
+    if (row_x + width + GLYPH_PADDING > ATLAS_WIDTH)
+    {
+      row_x = GLYPH_PADDING;
+      row_y += row_height + GLYPH_PADDING;
+      row_height = 0;
+    }
+
+    glyph_x[code_point] = row_x;
+    glyph_y[code_point] = row_y;
+
+    row_x += width + GLYPH_PADDING;
+    row_height = std::max(row_height, height);
+
+    std::vector<unsigned char>& bitmap = bitmaps[code_point];
+    bitmap.resize(width * height);
+
+    for (unsigned y = 0; y != height; ++y)
+      std::copy(slot->bitmap.buffer + y * slot->bitmap.pitch,
+                slot->bitmap.buffer + y * slot->bitmap.pitch + width,
+                bitmap.begin() + y * width);
+  }
+
+  FT_Done_Face(face);
+  FT_Done_FreeType(library);
+
+  unsigned used_height = row_y + row_height + GLYPH_PADDING;
+
+  atlas->height = 1;
+
+  while (atlas->height < used_height)
+    atlas->height *= 2;
+
+  atlas->pixels.assign(atlas->width * atlas->height, 0);
+
+  // Bitmap rows run top down, v0 is the top of a glyph
+  for (unsigned code_point = 0; code_point != Atlas::GLYPH_NUM; ++code_point)
+  {
+    Atlas::Glyph& glyph = atlas->glyphs[code_point];
+    std::vector<unsigned char> const& bitmap = bitmaps[code_point];
+
+    if (bitmap.empty())
+      continue;
+
+    unsigned width = glyph.width;
+    unsigned height = glyph.height;
+
+    for (unsigned y = 0; y != height; ++y)
+      std::copy(bitmap.begin() + y * width, bitmap.begin() + (y + 1) * width,
+                atlas->pixels.begin() + (glyph_y[code_point] + y) * atlas->width + glyph_x[code_point]);
+
+    glyph.u0 = (float) glyph_x[code_point] / atlas->width;
+    glyph.v0 = (float) glyph_y[code_point] / atlas->height;
+    glyph.u1 = (float) (glyph_x[code_point] + width) / atlas->width;
+    glyph.v1 = (float) (glyph_y[code_point] + height) / atlas->height;
+  }
+
+  atlases[key.str()] = atlas;
+
+  return atlas;
+}
+
+
+} // namespace vta
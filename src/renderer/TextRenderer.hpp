@@ -0,0 +1,90 @@
+#ifndef TEXT_RENDERER_HPP
+#define TEXT_RENDERER_HPP
+
+// vta
+#include <renderer/VertexBuffer.hpp>
+
+// gloost
+#include <gloost/gl/ShaderProgram.h>
+#include <gloost/gl/UniformSet.h>
+#include <gloost/Matrix.h>
+
+// cpp
+#include <memory>
+#include <string>
+#include <vector>
+
+// gl
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+
+namespace vta
+{
+
+  // Batched text. The glyphs of a font (Latin-1) are rasterized with FreeType
+  // into one atlas, once per font and size for all renderers (the texture is
+  // created per context). add_text() appends one quad per glyph to a vertex
+  // buffer, draw() draws all of them with one instanced draw call. The quads
+  // are only uploaded if they differ from the last frame.
+  // Text is UTF-8, other characters are drawn as '?'.
+
+  class TextRenderer
+  {
+    public:
+      // Class constructor
+      TextRenderer();
+
+      // Class destructor
+      ~TextRenderer();
+
+      // Load the font with a pixel size and create the gl resources
+      bool initialize(std::string const&, float);
+
+      // Reload the text shader from its files
+      void reload_shaders();
+
+      // Text color of the following add_text() calls
+      void set_color(float, float, float, float);
+
+      // Remove all text
+      void clear();
+
+      // Append a line at a pixel position (baseline) with a scale, returns
+      // its width
+      float add_text(float, float, std::string const&, float scale = 1.0f);
+
+      // Width of a line in pixels without adding it
+      float get_text_width(std::string const&, float scale = 1.0f) const;
+
+      // Distance of two lines in pixels
+      float get_line_height(float scale = 1.0f) const;
+
+      // Draw all text with projection and view (pixel coordinates)
+      void draw(gloost::Matrix const&, gloost::Matrix const&);
+
+    private:
+      // Rasterized glyphs of a font, shared by all renderers
+      struct Atlas;
+
+      std::shared_ptr<Atlas const> _atlas;
+
+      GLuint _texture;
+
+      float _color[4];
+
+      // Quads: vec4(x0, y0, x1, y1) + vec4(u0, v0, u1, v1) + vec4(color)
+      std::vector<float> _glyphs;
+      VertexBuffer _vboGlyphs;
+
+      gloost::gl::UniformSet _uniformSet;
+      std::shared_ptr<gloost::gl::ShaderProgram> _textShader;
+
+      // Rasterize a font or get it from the cache
+      static std::shared_ptr<Atlas const> load_atlas(std::string const&, float);
+  };
+
+
+} // Namespace vta
+
+#endif // TEXT_RENDERER_HPP
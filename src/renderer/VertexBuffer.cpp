@@ -0,0 +1,418 @@
+#include "VertexBuffer.hpp"
+
+// cpp
+#include <algorithm>
+#include <cstring>
+
+
+namespace vta
+{
+
+VertexBuffer::VertexBuffer()
+ : _format(),
+   _vertex_size(0),
+   _vertices(),
+   _reallocate(true),
+   _buffer(0),
+   _index_buffer(0),
+   _persistent(false),
+   _mapped(nullptr),
+   _region_num(1),
+   _current(0),
+   _uploaded_bytes(0)
+{
+  for (unsigned i_region = 0; i_region != REGION_NUM; ++i_region)
+  {
+    _regions[i_region].vertex_array = 0;
+    _regions[i_region].instance_array = 0;
+    _regions[i_region].fence = 0;
+  }
+}
+
+
+VertexBuffer::~VertexBuffer()
+{
+  release();
+}
+
+
+void
+VertexBuffer::set_format(std::vector<unsigned> const& format)
+{
+  _format = format;
+  _vertex_size = 0;
+
+  for (unsigned i = 0; i != format.size(); ++i)
+    _vertex_size += format[i];
+
+  _vertices.clear();
+  _reallocate = true;
+}
+
+
+void
+VertexBuffer::resize(unsigned vertex_num)
+{
+  if (vertex_num == get_vertex_num())
+    return;
+
+  _vertices.resize(vertex_num * _vertex_size, 0.0f);
+  _reallocate = true;
+}
+
+
+unsigned
+VertexBuffer::get_vertex_num() const
+{
+  return _vertex_size ? _vertices.size() / _vertex_size : 0;
+}
+
+
+unsigned
+VertexBuffer::get_vertex_size() const
+{
+  return _vertex_size;
+}
+
+
+void
+VertexBuffer::write(unsigned first, std::vector<float> const& vertices)
+{
+  std::copy(vertices.begin(), vertices.end(), _vertices.begin() + first * _vertex_size);
+
+  mark_dirty(first, first + vertices.size() / _vertex_size);
+}
+
+
+bool
+VertexBuffer::update(unsigned first, std::vector<float> const& vertices)
+{
+  if (std::equal(vertices.begin(), vertices.end(), _vertices.begin() + first * _vertex_size))
+    return false;
+
+  write(first, vertices);
+
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Uploads the dirty ranges
+  \remarks Stays on the current copy if nothing was written since the last
+           commit. Otherwise the next copy is written with all ranges it
+           missed since it was drawn last.
+*/
+
+void
+VertexBuffer::commit()
+{
+  _uploaded_bytes = 0;
+
+  if (_reallocate)
+  {
+    release();
+
+    if (!_vertices.empty())
+      allocate();
+
+    _reallocate = false;
+  }
+
+  if (!_buffer || _regions[_current].dirty.empty())
+    return;
+
+  if (_persistent)
+  {
+    _current = (_current + 1) % _region_num;
+    wait(_regions[_current]);
+  }
+
+  Region& region = _regions[_current];
+
+  unsigned region_size = _vertices.size();
+
+  if (!_persistent)
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+
+  for (unsigned i_range = 0; i_range != region.dirty.size(); ++i_range)
+  {
+    unsigned begin = region.dirty[i_range].begin * _vertex_size;
+    unsigned size = (region.dirty[i_range].end - region.dirty[i_range].begin) * _vertex_size;
+
+    if (_persistent)
+      memcpy(_mapped + _current * region_size + begin, &_vertices[begin], size * sizeof(float));
+    else
+      glBufferSubData(GL_ARRAY_BUFFER, begin * sizeof(float), size * sizeof(float), &_vertices[begin]);
+
+    _uploaded_bytes += size * sizeof(float);
+  }
+
+  if (!_persistent)
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  region.dirty.clear();
+}
+
+
+void
+VertexBuffer::bind() const
+{
+  if (_buffer)
+    glBindVertexArray(_regions[_current].vertex_array);
+}
+
+
+void
+VertexBuffer::bind_instanced() const
+{
+  if (_buffer)
+    glBindVertexArray(_regions[_current].instance_array);
+}
+
+
+void
+VertexBuffer::set_first_instance(unsigned first_instance) const
+{
+  if (_buffer)
+    set_instance_pointers(_current, first_instance);
+}
+
+
+void
+VertexBuffer::unbind() const
+{
+  glBindVertexArray(0);
+}
+
+
+void
+VertexBuffer::fence()
+{
+  if (!_buffer || !_persistent)
+    return;
+
+  Region& region = _regions[_current];
+
+  if (region.fence)
+    glDeleteSync(region.fence);
+
+  region.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+
+unsigned
+VertexBuffer::get_uploaded_bytes() const
+{
+  return _uploaded_bytes;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Creates the gpu buffer and two vertex arrays per copy (per vertex
+           and per instance)
+  \remarks Every copy starts with all vertices dirty
+*/
+
+void
+VertexBuffer::allocate()
+{
+  _persistent = GLEW_ARB_buffer_storage;
+  _region_num = _persistent ? REGION_NUM : 1;
+  _current = 0;
+
+  GLsizeiptr region_bytes = _vertices.size() * sizeof(float);
+
+  glGenBuffers(1, &_buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+
+  if (_persistent)
+  {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glBufferStorage(GL_ARRAY_BUFFER, region_bytes * _region_num, nullptr, flags);
+    _mapped = (float*) glMapBufferRange(GL_ARRAY_BUFFER, 0, region_bytes * _region_num, flags);
+  }
+  else
+  {
+    glBufferData(GL_ARRAY_BUFFER, region_bytes, nullptr, GL_DYNAMIC_DRAW);
+  }
+
+  // Vertex indices for the instanced vertex arrays
+  std::vector<GLuint> indices(get_vertex_num());
+
+  for (unsigned i = 0; i != indices.size(); ++i)
+    indices[i] = i;
+
+  glGenBuffers(1, &_index_buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, _index_buffer);
+  glBufferData(GL_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+
+  for (unsigned i_region = 0; i_region != _region_num; ++i_region)
+  {
+    Region& region = _regions[i_region];
+
+    glGenVertexArrays(1, &region.vertex_array);
+    glGenVertexArrays(1, &region.instance_array);
+
+    glBindVertexArray(region.vertex_array);
+
+    unsigned offset = 0;
+
+    for (unsigned i_attribute = 0; i_attribute != _format.size(); ++i_attribute)
+    {
+      glEnableVertexAttribArray(i_attribute);
+      glVertexAttribPointer(i_attribute, _format[i_attribute], GL_FLOAT, GL_FALSE, _vertex_size * sizeof(float),
+                            (GLvoid*) (i_region * region_bytes + offset * sizeof(float)));
+
+      offset += _format[i_attribute];
+    }
+
+    // Per instance attributes plus the index attribute
+    glBindVertexArray(region.instance_array);
+
+    for (unsigned i_attribute = 0; i_attribute != _format.size() + 1; ++i_attribute)
+    {
+      glEnableVertexAttribArray(i_attribute);
+      glVertexAttribDivisor(i_attribute, 1);
+    }
+
+    set_instance_pointers(i_region, 0);
+
+    Range all = { 0, get_vertex_num() };
+    region.dirty.assign(1, all);
+  }
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+void
+VertexBuffer::set_instance_pointers(unsigned i_region, unsigned first_instance) const
+{
+  GLsizeiptr region_bytes = _vertices.size() * sizeof(float);
+
+  unsigned offset = first_instance * _vertex_size;
+
+  glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+
+  for (unsigned i_attribute = 0; i_attribute != _format.size(); ++i_attribute)
+  {
+    glVertexAttribPointer(i_attribute, _format[i_attribute], GL_FLOAT, GL_FALSE, _vertex_size * sizeof(float),
+                          (GLvoid*) (i_region * region_bytes + offset * sizeof(float)));
+
+    offset += _format[i_attribute];
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, _index_buffer);
+  glVertexAttribIPointer(_format.size(), 1, GL_UNSIGNED_INT, 0, (GLvoid*) (first_instance * sizeof(GLuint)));
+  glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+}
+
+
+void
+VertexBuffer::release()
+{
+  for (unsigned i_region = 0; i_region != REGION_NUM; ++i_region)
+  {
+    Region& region = _regions[i_region];
+
+    if (region.fence)
+      glDeleteSync(region.fence);
+
+    if (region.vertex_array)
+    {
+      glDeleteVertexArrays(1, &region.vertex_array);
+      glDeleteVertexArrays(1, &region.instance_array);
+    }
+
+    region.fence = 0;
+    region.vertex_array = 0;
+    region.instance_array = 0;
+    region.dirty.clear();
+  }
+
+  if (_buffer)
+  {
+    if (_mapped)
+    {
+      glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    glDeleteBuffers(1, &_buffer);
+    glDeleteBuffers(1, &_index_buffer);
+  }
+
+  _buffer = 0;
+  _index_buffer = 0;
+  _mapped = nullptr;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Adds a vertex range to the dirty ranges of every copy
+  \remarks Overlapping or touching ranges are merged, too many ranges become
+           one range over all of them
+*/
+
+void
+VertexBuffer::mark_dirty(unsigned begin, unsigned end)
+{
+  if (begin == end)
+    return;
+
+  for (unsigned i_region = 0; i_region != _region_num; ++i_region)
+  {
+    std::vector<Range>& dirty = _regions[i_region].dirty;
+
+    if (!dirty.empty() && begin <= dirty.back().end && dirty.back().begin <= end)
+    {
+      dirty.back().begin = std::min(dirty.back().begin, begin);
+      dirty.back().end = std::max(dirty.back().end, end);
+    }
+    else
+    {
+      Range range = { begin, end };
+      dirty.push_back(range);
+    }
+
+    if (dirty.size() > MAX_RANGE_NUM)
+    {
+      Range all = dirty.front();
+
+      for (unsigned i_range = 1; i_range != dirty.size(); ++i_range)
+      {
+        all.begin = std::min(all.begin, dirty[i_range].begin);
+        all.end = std::max(all.end, dirty[i_range].end);
+      }
+
+      dirty.assign(1, all);
+    }
+  }
+}
+
+
+void
+VertexBuffer::wait(Region& region)
+{
+  if (!region.fence)
+    return;
+
+  while (glClientWaitSync(region.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+    ;
+
+  glDeleteSync(region.fence);
+  region.fence = 0;
+}
+
+
+} // namespace vta
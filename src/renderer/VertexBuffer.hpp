@@ -0,0 +1,126 @@
+#ifndef VERTEX_BUFFER_HPP
+#define VERTEX_BUFFER_HPP
+
+// cpp
+#include <vector>
+
+// gl
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+
+namespace vta
+{
+
+  // Vertex buffer of float attributes (locations 0, 1, ... in order) that is
+  // updated in ranges. Writes go to a cpu copy and mark their vertex range
+  // dirty, commit() uploads only the dirty ranges.
+  // With ARB_buffer_storage the buffer is mapped persistently and holds three
+  // copies: commit() writes the copy after the one drawn last, after waiting
+  // for the fence of its last draw, so the cpu never stalls on a frame the gpu
+  // is still drawing. Without it there is one copy updated with
+  // glBufferSubData().
+
+  class VertexBuffer
+  {
+    public:
+      // Class constructor
+      VertexBuffer();
+
+      // Class destructor
+      ~VertexBuffer();
+
+      // Float components of every attribute, the buffer is cleared
+      void set_format(std::vector<unsigned> const&);
+
+      // Number of vertices, the content is kept, the gpu buffer reallocated
+      void resize(unsigned);
+      unsigned get_vertex_num() const;
+
+      // Floats per vertex
+      unsigned get_vertex_size() const;
+
+      // Overwrite vertices starting at a vertex
+      void write(unsigned, std::vector<float> const&);
+
+      // Overwrite vertices only if they differ, true if they did
+      bool update(unsigned, std::vector<float> const&);
+
+      // Upload dirty ranges to the copy that is drawn next
+      void commit();
+
+      // Bind the vertex array of the current copy
+      void bind() const;
+      void unbind() const;
+
+      // Bind a vertex array with one vertex per instance (attribute divisor 1).
+      // It has one more attribute (uint, location = attribute count) with the
+      // index of the vertex, which gl_InstanceID is not with a base instance.
+      void bind_instanced() const;
+
+      // Start the instance attributes of the bound instanced vertex array at a
+      // vertex, a base instance for drivers without ARB_base_instance. Reset
+      // to 0 after drawing.
+      void set_first_instance(unsigned) const;
+
+      // Call after the last draw of the current copy in a frame
+      void fence();
+
+      // Bytes uploaded by the last commit()
+      unsigned get_uploaded_bytes() const;
+
+    private:
+      // Copies of the vertices in the gpu buffer
+      static const unsigned REGION_NUM = 3;
+
+      // Dirty ranges of one copy are merged into one above this count
+      static const unsigned MAX_RANGE_NUM = 1024;
+
+      struct Range
+      {
+        unsigned begin;
+        unsigned end;
+      };
+
+      struct Region
+      {
+        GLuint vertex_array;
+        GLuint instance_array;
+        GLsync fence;
+        // Vertex ranges not yet written to this copy
+        std::vector<Range> dirty;
+      };
+
+      std::vector<unsigned> _format;
+      unsigned _vertex_size;
+
+      // Cpu copy
+      std::vector<float> _vertices;
+
+      // Gpu buffer has to be recreated for a new format or size
+      bool _reallocate;
+
+      GLuint _buffer;
+      GLuint _index_buffer;
+      bool _persistent;
+      float* _mapped;
+      unsigned _region_num;
+      unsigned _current;
+      Region _regions[REGION_NUM];
+
+      unsigned _uploaded_bytes;
+
+      void allocate();
+      void release();
+
+      // Attribute pointers of the instanced vertex array of a copy, starting
+      // at a vertex (vertex array bound)
+      void set_instance_pointers(unsigned, unsigned) const;
+      void mark_dirty(unsigned, unsigned);
+      void wait(Region&);
+  };
+
+
+} // Namespace vta
+
+#endif // VERTEX_BUFFER_HPP
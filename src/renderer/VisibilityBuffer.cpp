@@ -0,0 +1,124 @@
+#include "VisibilityBuffer.hpp"
+
+
+namespace vta
+{
+
+VisibilityBuffer::VisibilityBuffer()
+ : _buffer(0),
+   _texture(0),
+   _words(),
+   _uploaded_word_num(0)
+{}
+
+
+VisibilityBuffer::~VisibilityBuffer()
+{
+  if (_texture)
+    glDeleteTextures(1, &_texture);
+
+  if (_buffer)
+    glDeleteBuffers(1, &_buffer);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Uploads the visibility bits
+  \remarks A size change reallocates the buffer, otherwise every run of
+           changed words is written with one glBufferSubData(). The shaders
+           read the 64 bit words as pairs of 32 bit texels (little endian).
+*/
+
+void
+VisibilityBuffer::update(std::vector<uint64_t> const& words)
+{
+  bool reallocate = !_buffer || words.size() != _words.size();
+
+  if (!_buffer)
+  {
+    glGenBuffers(1, &_buffer);
+    glGenTextures(1, &_texture);
+  }
+
+  _uploaded_word_num = 0;
+
+  glBindBuffer(GL_TEXTURE_BUFFER, _buffer);
+
+  if (reallocate)
+  {
+    _words = words;
+
+    // An empty buffer texture can not be sampled, keep at least one word
+    std::vector<uint64_t> data(words);
+
+    if (data.empty())
+      data.push_back(0);
+
+    glBufferData(GL_TEXTURE_BUFFER, data.size() * sizeof(uint64_t), &data[0], GL_DYNAMIC_DRAW);
+
+    // Attach the new storage
+    glBindTexture(GL_TEXTURE_BUFFER, _texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, _buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    _uploaded_word_num = words.size();
+  }
+  else
+  {
+    unsigned i_word = 0;
+
+    while (i_word != words.size())
+    {
+      if (words[i_word] == _words[i_word])
+      {
+        ++i_word;
+        continue;
+      }
+
+      unsigned run_begin = i_word;
+
+      while (i_word != words.size() && words[i_word] != _words[i_word])
+      {
+        _words[i_word] = words[i_word];
+        ++i_word;
+      }
+
+      glBufferSubData(GL_TEXTURE_BUFFER, run_begin * sizeof(uint64_t),
+                      (i_word - run_begin) * sizeof(uint64_t), &_words[run_begin]);
+
+      _uploaded_word_num += i_word - run_begin;
+    }
+  }
+
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+
+void
+VisibilityBuffer::bind(unsigned unit) const
+{
+  glActiveTexture(GL_TEXTURE0 + unit);
+  glBindTexture(GL_TEXTURE_BUFFER, _texture);
+  glActiveTexture(GL_TEXTURE0);
+}
+
+
+void
+VisibilityBuffer::unbind(unsigned unit) const
+{
+  glActiveTexture(GL_TEXTURE0 + unit);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glActiveTexture(GL_TEXTURE0);
+}
+
+
+unsigned
+VisibilityBuffer::get_uploaded_word_num() const
+{
+  return _uploaded_word_num;
+}
+
+
+} // namespace vta
@@ -0,0 +1,53 @@
+#ifndef VISIBILITY_BUFFER_HPP
+#define VISIBILITY_BUFFER_HPP
+
+// cpp
+#include <vector>
+#include <stdint.h>
+
+// gl
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+
+namespace vta
+{
+
+  // One visibility bit per vertex slot in a buffer texture (R32UI), read by
+  // the node and edge shaders to cull hidden nodes and edges. The words are
+  // kept on the cpu as well, an update only uploads the runs of words that
+  // changed, the geometry buffers are never touched.
+
+  class VisibilityBuffer
+  {
+    public:
+      // Class constructor
+      VisibilityBuffer();
+
+      // Class destructor
+      ~VisibilityBuffer();
+
+      // Upload the bits (bit i of word i / 64 is slot i), only changed words
+      void update(std::vector<uint64_t> const&);
+
+      // Bind the buffer texture to a texture unit (GL_TEXTURE0 + unit)
+      void bind(unsigned) const;
+      void unbind(unsigned) const;
+
+      // Number of words uploaded by the last update()
+      unsigned get_uploaded_word_num() const;
+
+    private:
+      GLuint _buffer;
+      GLuint _texture;
+
+      // Copy of the uploaded words
+      std::vector<uint64_t> _words;
+
+      unsigned _uploaded_word_num;
+  };
+
+
+} // Namespace vta
+
+#endif // VISIBILITY_BUFFER_HPP
@@ -0,0 +1,388 @@
+#include "FrameProfiler.hpp"
+
+// cpp
+#include <algorithm>
+#include <iostream>
+
+
+namespace vta
+{
+
+namespace
+{
+  // Milliseconds between two time points
+  float elapsed_ms(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+  {
+    return std::chrono::duration<float, std::milli>(end - start).count();
+  }
+
+
+  // Percentile of sorted samples (nearest rank)
+  float percentile(std::vector<float> const& sorted, float p)
+  {
+    if (sorted.empty())
+      return 0.0f;
+
+    unsigned rank = std::min<unsigned>(sorted.size() - 1, (unsigned) (p * sorted.size()));
+
+    return sorted[rank];
+  }
+}
+
+
+FrameProfiler::CpuScope::CpuScope(char const* name)
+ : _name(name),
+   _start()
+{
+  if (FrameProfiler::get().is_enabled())
+    _start = std::chrono::steady_clock::now();
+}
+
+
+FrameProfiler::CpuScope::~CpuScope()
+{
+  if (FrameProfiler::get().is_enabled())
+    FrameProfiler::get().add_cpu_time(_name, elapsed_ms(_start, std::chrono::steady_clock::now()));
+}
+
+
+FrameProfiler::GpuScope::GpuScope(char const* name)
+ : _active(FrameProfiler::get().begin_gpu(name))
+{}
+
+
+FrameProfiler::GpuScope::~GpuScope()
+{
+  if (_active)
+    FrameProfiler::get().end_gpu();
+}
+
+
+FrameProfiler::FrameProfiler()
+ : _enabled(true),
+   _window_size(DEFAULT_WINDOW_SIZE),
+   _frame(0),
+   _frame_start(std::chrono::steady_clock::now()),
+   _cpu_sections(),
+   _gpu_sections(),
+   _active_gpu(),
+   _csv()
+{}
+
+
+/*static*/
+FrameProfiler&
+FrameProfiler::get()
+{
+  static FrameProfiler profiler;
+  return profiler;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Class destructor
+  \remarks Query objects are not deleted, the contexts that own them are
+           usually gone at this point
+*/
+
+FrameProfiler::~FrameProfiler()
+{
+  close_csv();
+}
+
+
+void
+FrameProfiler::set_enabled(bool enabled)
+{
+  _enabled = enabled;
+}
+
+
+bool
+FrameProfiler::is_enabled() const
+{
+  return _enabled;
+}
+
+
+void
+FrameProfiler::set_window_size(unsigned window_size)
+{
+  _window_size = std::max(1u, window_size);
+
+  for (std::map<std::string, Section>::iterator i = _cpu_sections.begin(); i != _cpu_sections.end(); ++i)
+  {
+    i->second.samples.clear();
+    i->second.next_sample = 0;
+  }
+
+  for (std::map<std::string, Section>::iterator i = _gpu_sections.begin(); i != _gpu_sections.end(); ++i)
+  {
+    i->second.samples.clear();
+    i->second.next_sample = 0;
+  }
+}
+
+
+unsigned
+FrameProfiler::get_window_size() const
+{
+  return _window_size;
+}
+
+
+void
+FrameProfiler::begin_frame()
+{
+  _frame_start = std::chrono::steady_clock::now();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Ends the frame
+  \remarks Every cpu section measured during the frame gets one sample with
+           the summed time of the frame
+*/
+
+void
+FrameProfiler::end_frame()
+{
+  if (_enabled)
+  {
+    add_cpu_time("frame", elapsed_ms(_frame_start, std::chrono::steady_clock::now()));
+
+    for (std::map<std::string, Section>::iterator i = _cpu_sections.begin(); i != _cpu_sections.end(); ++i)
+    {
+      Section& section = i->second;
+
+      if (!section.measured)
+        continue;
+
+      add_sample(i->first, section, section.frame_time, _frame, "cpu");
+
+      section.frame_time = 0.0f;
+      section.measured = false;
+    }
+
+    if (_csv.is_open())
+      _csv.flush();
+  }
+
+  ++_frame;
+}
+
+
+unsigned
+FrameProfiler::get_frame() const
+{
+  return _frame;
+}
+
+
+void
+FrameProfiler::add_cpu_time(char const* name, float ms)
+{
+  Section& section = get_section(name, false);
+
+  section.frame_time += ms;
+  section.measured = true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Starts a GL_TIME_ELAPSED query for a gpu section
+  \remarks Returns false if nothing is measured (profiler disabled or another
+           gpu section active). The results of earlier frames are collected
+           first, their queries are reused.
+*/
+
+bool
+FrameProfiler::begin_gpu(char const* name)
+{
+  if (!_enabled || !_active_gpu.empty())
+    return false;
+
+  Section& section = get_section(name, true);
+
+  collect(name, section);
+
+  PendingQuery pending;
+  pending.frame = _frame;
+
+  if (section.free_queries.empty())
+  {
+    glGenQueries(1, &pending.query);
+  }
+  else
+  {
+    pending.query = section.free_queries.back();
+    section.free_queries.pop_back();
+  }
+
+  glBeginQuery(GL_TIME_ELAPSED, pending.query);
+
+  section.pending.push_back(pending);
+  _active_gpu = name;
+
+  return true;
+}
+
+
+void
+FrameProfiler::end_gpu()
+{
+  glEndQuery(GL_TIME_ELAPSED);
+
+  _active_gpu.clear();
+}
+
+
+std::vector<FrameProfiler::Statistics>
+FrameProfiler::get_statistics() const
+{
+  std::vector<Statistics> statistics;
+  std::vector<float> sorted;
+
+  std::vector<std::map<std::string, Section>::const_iterator> sections;
+
+  for (std::map<std::string, Section>::const_iterator i = _cpu_sections.begin(); i != _cpu_sections.end(); ++i)
+    sections.push_back(i);
+
+  for (std::map<std::string, Section>::const_iterator i = _gpu_sections.begin(); i != _gpu_sections.end(); ++i)
+    sections.push_back(i);
+
+  for (unsigned i_section = 0; i_section != sections.size(); ++i_section)
+  {
+    std::map<std::string, Section>::const_iterator i = sections[i_section];
+    Section const& section = i->second;
+
+    sorted = section.samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    Statistics entry;
+    entry.name = i->first;
+    entry.gpu = section.gpu;
+    entry.last = section.last;
+    entry.p50 = percentile(sorted, 0.50f);
+    entry.p95 = percentile(sorted, 0.95f);
+    entry.p99 = percentile(sorted, 0.99f);
+    entry.sample_num = sorted.size();
+
+    statistics.push_back(entry);
+  }
+
+  return statistics;
+}
+
+
+bool
+FrameProfiler::open_csv(std::string const& path)
+{
+  close_csv();
+
+  _csv.open(path.c_str());
+
+  if (!_csv.is_open())
+  {
+    std::cerr << "Could not open profile: " << path << std::endl;
+    return false;
+  }
+
+  _csv << "frame,section,type,ms" << std::endl;
+
+  return true;
+}
+
+
+void
+FrameProfiler::close_csv()
+{
+  if (_csv.is_open())
+    _csv.close();
+}
+
+
+bool
+FrameProfiler::is_csv_open() const
+{
+  return _csv.is_open();
+}
+
+
+FrameProfiler::Section&
+FrameProfiler::get_section(std::string const& name, bool gpu)
+{
+  std::map<std::string, Section>& sections = gpu ? _gpu_sections : _cpu_sections;
+
+  std::map<std::string, Section>::iterator i = sections.find(name);
+
+  if (i == sections.end())
+  {
+    Section section;
+    section.gpu = gpu;
+    section.frame_time = 0.0f;
+    section.measured = false;
+    section.next_sample = 0;
+    section.last = 0.0f;
+
+    i = sections.insert(std::make_pair(name, section)).first;
+  }
+
+  return i->second;
+}
+
+
+void
+FrameProfiler::add_sample(std::string const& name, Section& section, float ms, unsigned frame, char const* type)
+{
+  if (section.samples.size() < _window_size)
+    section.samples.push_back(ms);
+  else
+    section.samples[section.next_sample] = ms;
+
+  section.next_sample = (section.next_sample + 1) % _window_size;
+  section.last = ms;
+
+  if (_csv.is_open())
+    _csv << frame << ',' << name << ',' << type << ',' << ms << '\n';
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Reads the finished queries of a gpu section
+  \remarks Queries finish in order, the first unavailable one stops
+*/
+
+void
+FrameProfiler::collect(std::string const& name, Section& section)
+{
+  while (!section.pending.empty())
+  {
+    PendingQuery const& pending = section.pending.front();
+
+    GLuint available = 0;
+    glGetQueryObjectuiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+    if (!available)
+      break;
+
+    GLuint64 ns = 0;
+    glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &ns);
+
+    add_sample(name, section, ns / 1.0e6f, pending.frame, "gpu");
+
+    section.free_queries.push_back(pending.query);
+    section.pending.pop_front();
+  }
+}
+
+
+} // namespace vta
@@ -0,0 +1,162 @@
+#ifndef FRAME_PROFILER_HPP
+#define FRAME_PROFILER_HPP
+
+// cpp
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <fstream>
+#include <chrono>
+
+// gl
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+
+namespace vta
+{
+
+  // Per frame timings of named sections. Cpu sections are measured with
+  // steady_clock and summed per frame, gpu sections with GL_TIME_ELAPSED
+  // queries. Gpu results arrive a few frames late, they are read when the
+  // section is measured again, so they are always read in the context that
+  // issued them (query objects are not shared between contexts). Gpu
+  // sections must not nest, one query of a type can be active at a time.
+  // The last samples of every section (a window of DEFAULT_WINDOW_SIZE
+  // frames, can be changed) give the percentiles, samples can also be
+  // streamed to a csv file (frame,section,type,ms).
+  // Only used from the render thread.
+
+  class FrameProfiler
+  {
+    public:
+      // Timings of one section in milliseconds
+      struct Statistics
+      {
+        std::string name;
+        bool gpu;
+        float last;
+        float p50;
+        float p95;
+        float p99;
+        unsigned sample_num;
+      };
+
+      // Measures a cpu section while in scope
+      class CpuScope
+      {
+        public:
+          CpuScope(char const*);
+          ~CpuScope();
+
+        private:
+          char const* _name;
+          std::chrono::steady_clock::time_point _start;
+      };
+
+      // Measures a gpu section while in scope
+      class GpuScope
+      {
+        public:
+          GpuScope(char const*);
+          ~GpuScope();
+
+        private:
+          bool _active;
+      };
+
+      // Number of samples of the percentiles
+      static const unsigned DEFAULT_WINDOW_SIZE = 240;
+
+      // Class constructor
+      FrameProfiler();
+
+      // Class destructor
+      ~FrameProfiler();
+
+      // Profiler of the render thread
+      static FrameProfiler& get();
+
+      // Measuring can be switched off, scopes are free then
+      void set_enabled(bool);
+      bool is_enabled() const;
+
+      // Number of samples of the percentiles, drops the current samples
+      void set_window_size(unsigned);
+      unsigned get_window_size() const;
+
+      // Frame borders, the frame is measured as cpu section "frame"
+      void begin_frame();
+      void end_frame();
+
+      unsigned get_frame() const;
+
+      // Add a cpu sample to the current frame
+      void add_cpu_time(char const*, float);
+
+      // Start and stop a gpu query (see GpuScope)
+      bool begin_gpu(char const*);
+      void end_gpu();
+
+      // Statistics of all cpu sections, then all gpu sections, sorted by name
+      std::vector<Statistics> get_statistics() const;
+
+      // Stream samples to a csv file until close_csv()
+      bool open_csv(std::string const&);
+      void close_csv();
+      bool is_csv_open() const;
+
+    private:
+      // Query of a frame waiting for its result
+      struct PendingQuery
+      {
+        GLuint query;
+        unsigned frame;
+      };
+
+      struct Section
+      {
+        bool gpu;
+
+        // Cpu: time of the current frame
+        float frame_time;
+        bool measured;
+
+        // Last samples (ring buffer)
+        std::vector<float> samples;
+        unsigned next_sample;
+        float last;
+
+        // Gpu: issued and free queries
+        std::deque<PendingQuery> pending;
+        std::vector<GLuint> free_queries;
+      };
+
+      bool _enabled;
+
+      unsigned _window_size;
+
+      unsigned _frame;
+      std::chrono::steady_clock::time_point _frame_start;
+
+      // A name can be used for a cpu and a gpu section
+      std::map<std::string, Section> _cpu_sections;
+      std::map<std::string, Section> _gpu_sections;
+
+      // Name of the active gpu section
+      std::string _active_gpu;
+
+      std::ofstream _csv;
+
+      Section& get_section(std::string const&, bool);
+      void add_sample(std::string const&, Section&, float, unsigned, char const*);
+
+      // Read the available results of a gpu section
+      void collect(std::string const&, Section&);
+  };
+
+
+} // Namespace vta
+
+#endif // FRAME_PROFILER_HPP
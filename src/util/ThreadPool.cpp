@@ -0,0 +1,299 @@
+#include "ThreadPool.hpp"
+
+// cpp
+#include <algorithm>
+
+
+namespace vta
+{
+
+namespace
+{
+  // Pool and queue of the current worker thread
+  thread_local ThreadPool const* current_pool = nullptr;
+  thread_local unsigned current_queue = 0;
+}
+
+
+ThreadPool::ThreadPool(unsigned thread_num)
+ : _queues(),
+   _threads(),
+   _caller_queues(),
+   _caller_mutex(),
+   _queued(0),
+   _sleep_mutex(),
+   _wake_up(),
+   _stop(false)
+{
+  thread_num = std::max(1u, thread_num);
+
+  for (unsigned i_queue = 0; i_queue != thread_num; ++i_queue)
+    _queues.push_back(std::unique_ptr<Queue>(new Queue()));
+
+  for (unsigned i_thread = 0; i_thread != thread_num; ++i_thread)
+    _threads.push_back(std::thread(&ThreadPool::worker_loop, this, i_thread));
+}
+
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(_sleep_mutex);
+    _stop = true;
+  }
+  _wake_up.notify_all();
+
+  for (unsigned i_thread = 0; i_thread != _threads.size(); ++i_thread)
+    _threads[i_thread].join();
+}
+
+
+/*static*/
+ThreadPool&
+ThreadPool::get()
+{
+  static ThreadPool pool(std::thread::hardware_concurrency());
+  return pool;
+}
+
+
+unsigned
+ThreadPool::get_thread_num() const
+{
+  return _threads.size();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Run all tasks and wait for them
+  \remarks The calling thread runs the tasks of this batch that were not
+           stolen (newest first), then sleeps until the others are done
+*/
+
+void
+ThreadPool::run(std::vector<Task> const& tasks)
+{
+  if (tasks.empty())
+    return;
+
+  Batch batch;
+  batch.pending = tasks.size();
+
+  // Workers push to their own queue, other threads to one of this call
+  Queue caller_queue;
+  bool worker = (current_pool == this);
+  Queue& queue = worker ? *_queues[current_queue] : caller_queue;
+
+  {
+    std::lock_guard<std::mutex> lock(_sleep_mutex);
+    _queued += tasks.size();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    for (unsigned i_task = 0; i_task != tasks.size(); ++i_task)
+    {
+      Item item = { &tasks[i_task], &batch };
+      queue.items.push_back(item);
+    }
+  }
+
+  if (!worker)
+  {
+    std::lock_guard<std::mutex> lock(_caller_mutex);
+    _caller_queues.push_back(&caller_queue);
+  }
+
+  _wake_up.notify_all();
+
+  // Help with the own batch, nested batches above it are done at this point
+  for (;;)
+  {
+    Item item = { nullptr, nullptr };
+
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+
+      if (!queue.items.empty() && queue.items.back().batch == &batch)
+      {
+        item = queue.items.back();
+        queue.items.pop_back();
+      }
+    }
+
+    if (!item.task)
+      break;
+
+    --_queued;
+    execute(item);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(batch.mutex);
+    batch.done.wait(lock, [&batch]() { return batch.pending == 0; });
+  }
+
+  if (!worker)
+  {
+    std::lock_guard<std::mutex> lock(_caller_mutex);
+    _caller_queues.erase(std::find(_caller_queues.begin(), _caller_queues.end(), &caller_queue));
+  }
+
+  if (batch.exception)
+    std::rethrow_exception(batch.exception);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Parallel loop over [begin, end)
+  \remarks Chunks are about four per thread but never smaller than grain
+*/
+
+void
+ThreadPool::parallel_for(unsigned begin, unsigned end, unsigned grain,
+                         std::function<void(unsigned, unsigned)> const& body)
+{
+  if (begin >= end)
+    return;
+
+  unsigned count = end - begin;
+  unsigned chunk = std::max(std::max(grain, 1u), count / (4 * get_thread_num()) + 1);
+
+  if (chunk >= count)
+  {
+    body(begin, end);
+    return;
+  }
+
+  std::vector<Task> tasks;
+
+  for (unsigned chunk_begin = begin; chunk_begin < end; chunk_begin += chunk)
+  {
+    unsigned chunk_end = std::min(end, chunk_begin + chunk);
+
+    tasks.push_back([&body, chunk_begin, chunk_end]() { body(chunk_begin, chunk_end); });
+
+    if (chunk_end == end)
+      break;
+  }
+
+  run(tasks);
+}
+
+
+void
+ThreadPool::worker_loop(unsigned index)
+{
+  current_pool = this;
+  current_queue = index;
+
+  for (;;)
+  {
+    if (try_run_one(index))
+      continue;
+
+    std::unique_lock<std::mutex> lock(_sleep_mutex);
+
+    _wake_up.wait(lock, [this]() { return _stop || _queued != 0; });
+
+    if (_stop)
+      return;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+  \brief   Run the newest task of the own queue or steal the oldest of another
+           worker or of a thread outside the pool
+  \remarks Returns false if all queues are empty
+*/
+
+bool
+ThreadPool::try_run_one(unsigned queue)
+{
+  Item item = { nullptr, nullptr };
+
+  for (unsigned i = 0; i != _queues.size() && !item.task; ++i)
+  {
+    unsigned victim = (queue + i) % _queues.size();
+
+    std::lock_guard<std::mutex> lock(_queues[victim]->mutex);
+
+    std::deque<Item>& items = _queues[victim]->items;
+
+    if (items.empty())
+      continue;
+
+    if (i == 0)
+    {
+      item = items.back();
+      items.pop_back();
+    }
+    else
+    {
+      item = items.front();
+      items.pop_front();
+    }
+  }
+
+  if (!item.task)
+  {
+    std::lock_guard<std::mutex> caller_lock(_caller_mutex);
+
+    for (unsigned i = 0; i != _caller_queues.size() && !item.task; ++i)
+    {
+      std::lock_guard<std::mutex> lock(_caller_queues[i]->mutex);
+
+      std::deque<Item>& items = _caller_queues[i]->items;
+
+      if (items.empty())
+        continue;
+
+      item = items.front();
+      items.pop_front();
+    }
+  }
+
+  if (!item.task)
+    return false;
+
+  --_queued;
+  execute(item);
+
+  return true;
+}
+
+
+void
+ThreadPool::execute(Item const& item)
+{
+  Batch* batch = item.batch;
+
+  try
+  {
+    (*item.task)();
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(batch->mutex);
+
+    if (!batch->exception)
+      batch->exception = std::current_exception();
+  }
+
+  // Notify under the lock, the waiting thread destroys the batch afterwards
+  std::lock_guard<std::mutex> lock(batch->mutex);
+
+  if (--batch->pending == 0)
+    batch->done.notify_all();
+}
+
+
+}
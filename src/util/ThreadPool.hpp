@@ -0,0 +1,98 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+// cpp
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+
+namespace vta
+{
+
+  // Work stealing thread pool. Every worker has its own task deque, it takes
+  // new work from the back and steals from the front of the others. Threads
+  // outside the pool get a deque per run() that the workers steal from.
+  // A thread waiting in run() only helps with the tasks of its own batch
+  // (so parallel_for can be called from inside a task) and then sleeps until
+  // the stolen ones are done, it never picks up unrelated work. The first
+  // exception of a batch is rethrown by run() after all tasks finished.
+
+  class ThreadPool
+  {
+    public:
+      typedef std::function<void()> Task;
+
+      // Class constructor
+      ThreadPool(unsigned);
+
+      // Class destructor
+      ~ThreadPool();
+
+      // Shared pool with one worker per core
+      static ThreadPool& get();
+
+      // Number of worker threads
+      unsigned get_thread_num() const;
+
+      // Run all tasks and wait until they are done
+      void run(std::vector<Task> const&);
+
+      // Run body(begin, end) on chunks of at least grain elements and wait
+      void parallel_for(unsigned, unsigned, unsigned, std::function<void(unsigned, unsigned)> const&);
+
+    private:
+      // Tasks of one run() call
+      struct Batch
+      {
+        unsigned pending;
+        std::exception_ptr exception;
+        std::mutex mutex;
+        std::condition_variable done;
+      };
+
+      struct Item
+      {
+        Task const* task;
+        Batch* batch;
+      };
+
+      struct Queue
+      {
+        std::deque<Item> items;
+        std::mutex mutex;
+      };
+
+      // One queue per worker
+      std::vector<std::unique_ptr<Queue> > _queues;
+      std::vector<std::thread> _threads;
+
+      // Queues of run() calls from threads outside the pool
+      std::vector<Queue*> _caller_queues;
+      std::mutex _caller_mutex;
+
+      // Number of queued tasks, workers sleep while it is zero
+      std::atomic<unsigned> _queued;
+      std::mutex _sleep_mutex;
+      std::condition_variable _wake_up;
+      bool _stop;
+
+      void worker_loop(unsigned);
+
+      // Take a task from the own queue or steal one
+      bool try_run_one(unsigned);
+
+      // Run a task and count it as done in its batch
+      void execute(Item const&);
+  };
+
+
+} // Namespace vta
+
+#endif // THREAD_POOL_HPP